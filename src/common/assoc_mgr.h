@@ -158,6 +158,9 @@ struct assoc_mgr_association_usage {
 					 * sorting (DON'T PACK) */
 	uint64_t priority_fs_ranked;	/* (LEVEL_BASED) Priority after
 					 * ranking (DON'T PACK) */
+	long double children_usage_norm; /* (DEPTH_OBLIVIOUS) sum of
+					  * usage_norm of children not using
+					  * parent's fairshare (DON'T PACK) */
 
 	bitstr_t *valid_qos;    /* qos available for this association
 				 * derived from the qos_list.
@@ -41,6 +41,7 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -65,6 +66,9 @@
 #define	_bit_mask(bit) ((bitstr_t)1 << ((bit)&BITSTR_MAXPOS))
 #endif
 
+/* number of bits in a bitstr word */
+#define _bitstr_word_bits	((bitoff_t) (sizeof(bitstr_t) * 8))
+
 /* number of bits actually allocated to a bitstr */
 #define _bitstr_bits(name) 	((name)[1])
 
@@ -92,6 +96,37 @@
  * external macros
  */
 
+/*
+ * Per-thread cache of freed bitstrings. The scheduler, backfill and select
+ * plugins allocate and free many temporary bitmaps of the same few sizes
+ * (node count and core count) while testing each job. Between
+ * bit_cache_begin() and bit_cache_end() a thread keeps some of the
+ * bitstrings it frees for reuse rather than returning them to malloc.
+ * Outside of such a scope bit_alloc() and bit_free() never use the cache.
+ * When a new size is freed and all slots are in use, the least recently
+ * used size is evicted.
+ */
+#define BITSTR_CACHE_SIZES	4	/* distinct bitstring sizes cached */
+#define BITSTR_CACHE_DEPTH	32	/* bitstrings cached of each size */
+#define BITSTR_CACHE_MAX_BITS	(1024 * 1024)	/* largest bitstring cached */
+
+typedef struct {
+	bitoff_t nbits;		/* size cached in this slot, 0 if unused */
+	uint32_t last_use;	/* value of use_cnt at last get or put */
+	int cnt;
+	bitstr_t *bits[BITSTR_CACHE_DEPTH];
+} bitstr_cache_slot_t;
+
+typedef struct {
+	int active;		/* bit_cache_begin() nesting depth */
+	uint32_t use_cnt;
+	bitstr_cache_slot_t slot[BITSTR_CACHE_SIZES];
+} bitstr_cache_t;
+
+static pthread_key_t bitstr_cache_key;
+static pthread_once_t bitstr_cache_once = PTHREAD_ONCE_INIT;
+static bool bitstr_cache_key_init = false;
+
 /* allocate a bitstring on the stack */
 /* XXX bit_decl does not check if nbits overflows word 1 */
 #define	bit_decl(name, nbits) \
@@ -113,6 +148,7 @@ strong_alias(bit_free,		slurm_bit_free);
 strong_alias(bit_realloc,	slurm_bit_realloc);
 strong_alias(bit_size,		slurm_bit_size);
 strong_alias(bit_and,		slurm_bit_and);
+strong_alias(bit_and_not,	slurm_bit_and_not);
 strong_alias(bit_not,		slurm_bit_not);
 strong_alias(bit_or,		slurm_bit_or);
 strong_alias(bit_set_count,	slurm_bit_set_count);
@@ -141,21 +177,283 @@ strong_alias(bit_nffs,		slurm_bit_nffs);
 strong_alias(bit_copybits,	slurm_bit_copybits);
 strong_alias(bit_get_bit_num,	slurm_bit_get_bit_num);
 strong_alias(bit_get_pos_num,	slurm_bit_get_pos_num);
+strong_alias(bit_cache_begin,	slurm_bit_cache_begin);
+strong_alias(bit_cache_end,	slurm_bit_cache_end);
+strong_alias(bit_cache_fini,	slurm_bit_cache_fini);
+
+#if !defined(USE_64BIT_BITSTR)
+typedef uint32_t bitstr_word_t;
+#else
+typedef uint64_t bitstr_word_t;
+#endif
 
 /*
- * Allocate a bitstring.
- *   nbits (IN)		valid bits in new bitstring, initialized to all clear
+ * Returns the hamming weight (i.e. the number of bits set) in a word.
+ * NOTE: The portable version is borrowed from Linux 2.4.9 <linux/bitops.h>.
+ */
+static inline bitstr_word_t
+hweight(bitstr_word_t w)
+{
+#if defined(__GNUC__) && !defined(USE_64BIT_BITSTR)
+	return __builtin_popcount(w);
+#elif defined(__GNUC__)
+	return __builtin_popcountll(w);
+#elif !defined(USE_64BIT_BITSTR)
+	bitstr_word_t res;
+
+	res = (w   & 0x55555555) + ((w >> 1)    & 0x55555555);
+	res = (res & 0x33333333) + ((res >> 2)  & 0x33333333);
+	res = (res & 0x0F0F0F0F) + ((res >> 4)  & 0x0F0F0F0F);
+	res = (res & 0x00FF00FF) + ((res >> 8)  & 0x00FF00FF);
+	res = (res & 0x0000FFFF) + ((res >> 16) & 0x0000FFFF);
+
+	return res;
+#else
+	bitstr_word_t res;
+
+	res = (w   & 0x5555555555555555) + ((w >> 1)    & 0x5555555555555555);
+	res = (res & 0x3333333333333333) + ((res >> 2)  & 0x3333333333333333);
+	res = (res & 0x0F0F0F0F0F0F0F0F) + ((res >> 4)  & 0x0F0F0F0F0F0F0F0F);
+	res = (res & 0x00FF00FF00FF00FF) + ((res >> 8)  & 0x00FF00FF00FF00FF);
+	res = (res & 0x0000FFFF0000FFFF) + ((res >> 16) & 0x0000FFFF0000FFFF);
+	res = (res & 0x00000000FFFFFFFF) + ((res >> 32) & 0x00000000FFFFFFFF);
+
+	return res;
+#endif
+}
+
+/*
+ * Return the offset within a word of the first (lowest numbered) bit set.
+ * The word must be non-zero.
+ */
+static inline bitoff_t
+_word_ffs(bitstr_word_t w)
+{
+#if defined(__GNUC__) && !defined(USE_64BIT_BITSTR)
+#  ifdef SLURM_BIGENDIAN
+	return __builtin_clz(w);
+#  else
+	return __builtin_ctz(w);
+#  endif
+#elif defined(__GNUC__)
+#  ifdef SLURM_BIGENDIAN
+	return __builtin_clzll(w);
+#  else
+	return __builtin_ctzll(w);
+#  endif
+#else
+	bitoff_t bit;
+
+	for (bit = 0; bit < BITSTR_MAXPOS; bit++) {
+		if (w & _bit_mask(bit))
+			break;
+	}
+	return bit;
+#endif
+}
+
+/*
+ * Return the offset within a word of the last (highest numbered) bit set.
+ * The word must be non-zero.
+ */
+static inline bitoff_t
+_word_fls(bitstr_word_t w)
+{
+#if defined(__GNUC__) && !defined(USE_64BIT_BITSTR)
+#  ifdef SLURM_BIGENDIAN
+	return BITSTR_MAXPOS - __builtin_ctz(w);
+#  else
+	return BITSTR_MAXPOS - __builtin_clz(w);
+#  endif
+#elif defined(__GNUC__)
+#  ifdef SLURM_BIGENDIAN
+	return BITSTR_MAXPOS - __builtin_ctzll(w);
+#  else
+	return BITSTR_MAXPOS - __builtin_clzll(w);
+#  endif
+#else
+	bitoff_t bit;
+
+	for (bit = BITSTR_MAXPOS; bit > 0; bit--) {
+		if (w & _bit_mask(bit))
+			break;
+	}
+	return bit;
+#endif
+}
+
+/*
+ * Return a mask of the valid bits in the last word of a bitstring with
+ * nbits bits. All bits are valid if nbits is a multiple of the word size.
+ */
+static inline bitstr_word_t
+_tail_mask(bitoff_t nbits)
+{
+	bitoff_t tail = nbits & BITSTR_MAXPOS;
+
+	if (tail == 0)
+		return ~((bitstr_word_t) 0);
+#ifdef SLURM_BIGENDIAN
+	return ~((bitstr_word_t) 0) << (_bitstr_word_bits - tail);
+#else
+	return (((bitstr_word_t) 1) << tail) - 1;
+#endif
+}
+
+/* Release all bitstrings held by a thread's cache and the cache itself */
+static void
+_bit_cache_destroy(void *arg)
+{
+	bitstr_cache_t *cache = (bitstr_cache_t *) arg;
+	int i;
+
+	if (!cache)
+		return;
+	for (i = 0; i < BITSTR_CACHE_SIZES; i++) {
+		while (cache->slot[i].cnt)
+			xfree(cache->slot[i].bits[--cache->slot[i].cnt]);
+	}
+	xfree(cache);
+}
+
+static void
+_bit_cache_key_create(void)
+{
+	if (pthread_key_create(&bitstr_cache_key, _bit_cache_destroy) == 0)
+		bitstr_cache_key_init = true;
+}
+
+/* Return the calling thread's cache if it is inside a bit_cache_begin()
+ * scope, otherwise NULL */
+static bitstr_cache_t *
+_bit_cache_active(bitoff_t nbits)
+{
+	bitstr_cache_t *cache;
+
+	if (!bitstr_cache_key_init ||
+	    (nbits <= 0) || (nbits > BITSTR_CACHE_MAX_BITS))
+		return NULL;
+	cache = pthread_getspecific(bitstr_cache_key);
+	if (!cache || !cache->active)
+		return NULL;
+	return cache;
+}
+
+/* Remove and return a bitstring of size nbits from the calling thread's
+ * cache, or NULL if none are available. The contents of its bits are
+ * undefined. */
+static bitstr_t *
+_bit_cache_get(bitoff_t nbits)
+{
+	bitstr_cache_t *cache = _bit_cache_active(nbits);
+	bitstr_cache_slot_t *slot;
+	int i;
+
+	if (!cache)
+		return NULL;
+
+	for (i = 0; i < BITSTR_CACHE_SIZES; i++) {
+		slot = &cache->slot[i];
+		if ((slot->nbits == nbits) && slot->cnt) {
+			slot->last_use = ++cache->use_cnt;
+			return slot->bits[--slot->cnt];
+		}
+	}
+	return NULL;
+}
+
+/* Add a bitstring being freed to the calling thread's cache, evicting the
+ * least recently used size if no slot holds this size yet.
+ * RET true if cached, false if it must be released by the caller */
+static bool
+_bit_cache_put(bitstr_t *b)
+{
+	bitoff_t nbits = _bitstr_bits(b);
+	bitstr_cache_t *cache = _bit_cache_active(nbits);
+	bitstr_cache_slot_t *slot = NULL;
+	int i;
+
+	if (!cache)
+		return false;
+
+	for (i = 0; i < BITSTR_CACHE_SIZES; i++) {
+		if (cache->slot[i].nbits == nbits) {
+			slot = &cache->slot[i];
+			break;
+		}
+		if (!slot || (cache->slot[i].last_use < slot->last_use))
+			slot = &cache->slot[i];
+	}
+	if (slot->nbits != nbits) {
+		while (slot->cnt)
+			xfree(slot->bits[--slot->cnt]);
+		slot->nbits = nbits;
+	}
+	slot->last_use = ++cache->use_cnt;
+	if (slot->cnt >= BITSTR_CACHE_DEPTH)
+		return false;
+	slot->bits[slot->cnt++] = b;
+	return true;
+}
+
+/*
+ * Start a scope in which the calling thread caches the bitstrings it frees
+ * for reuse by its later allocations. Scopes may nest. The cache is kept
+ * between scopes and released when the thread exits.
+ */
+void
+bit_cache_begin(void)
+{
+	bitstr_cache_t *cache;
+
+	pthread_once(&bitstr_cache_once, _bit_cache_key_create);
+	if (!bitstr_cache_key_init)
+		return;
+	if (!(cache = pthread_getspecific(bitstr_cache_key))) {
+		cache = xmalloc(sizeof(bitstr_cache_t));
+		pthread_setspecific(bitstr_cache_key, cache);
+	}
+	cache->active++;
+}
+
+/*
+ * End a scope started by bit_cache_begin().
+ */
+void
+bit_cache_end(void)
+{
+	bitstr_cache_t *cache;
+
+	if (!bitstr_cache_key_init)
+		return;
+	if ((cache = pthread_getspecific(bitstr_cache_key)) && cache->active)
+		cache->active--;
+}
+
+/*
+ * Allocate a bitstring, reusing a cached one of the same size if possible.
+ *   nbits (IN)		valid bits in new bitstring
+ *   clear (IN)		if set, initialize all bits clear
  *   RETURN		new bitstring
  */
-bitstr_t *
-bit_alloc(bitoff_t nbits)
+static bitstr_t *
+_bit_alloc(bitoff_t nbits, bool clear)
 {
 	bitstr_t *new;
 
-	new = (bitstr_t *)xmalloc(_bitstr_words(nbits) * sizeof(bitstr_t));
-	if (!new) {
-		log_oom(__FILE__, __LINE__, __CURRENT_FUNC__);
-		abort();
+	if ((new = _bit_cache_get(nbits))) {
+		if (clear) {
+			memset(&new[BITSTR_OVERHEAD], 0,
+			       (_bitstr_words(nbits) - BITSTR_OVERHEAD) *
+			       sizeof(bitstr_t));
+		}
+	} else {
+		new = (bitstr_t *)xmalloc(_bitstr_words(nbits) *
+					  sizeof(bitstr_t));
+		if (!new) {
+			log_oom(__FILE__, __LINE__, __CURRENT_FUNC__);
+			abort();
+		}
 	}
 
 	_bitstr_magic(new) = BITSTR_MAGIC;
@@ -163,6 +461,29 @@ bit_alloc(bitoff_t nbits)
 	return new;
 }
 
+/*
+ * Allocate a bitstring.
+ *   nbits (IN)		valid bits in new bitstring, initialized to all clear
+ *   RETURN		new bitstring
+ */
+bitstr_t *
+bit_alloc(bitoff_t nbits)
+{
+	return _bit_alloc(nbits, true);
+}
+
+/*
+ * Release the calling thread's cache of freed bitstrings.
+ */
+void
+bit_cache_fini(void)
+{
+	if (!bitstr_cache_key_init)
+		return;
+	_bit_cache_destroy(pthread_getspecific(bitstr_cache_key));
+	pthread_setspecific(bitstr_cache_key, NULL);
+}
+
 /*
  * Reallocate a bitstring (expand or contract size).
  *   b (IN)		pointer to old bitstring
@@ -197,7 +518,8 @@ bit_free(bitstr_t *b)
 	assert(b);
 	assert(_bitstr_magic(b) == BITSTR_MAGIC);
 	_bitstr_magic(b) = 0;
-	xfree(b);
+	if (!_bit_cache_put(b))
+		xfree(b);
 }
 
 /*
@@ -307,26 +629,22 @@ bit_nclear(bitstr_t *b, bitoff_t start, bitoff_t stop)
 bitoff_t
 bit_ffc(bitstr_t *b)
 {
-	bitoff_t bit = 0, value = -1;
+	bitoff_t word, word_cnt, bit;
 
 	_assert_bitstr_valid(b);
 
-	while (bit < _bitstr_bits(b) && value == -1) {
-		int32_t word = _bit_word(bit);
+	word_cnt = _bitstr_words(_bitstr_bits(b));
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++) {
+		bitstr_word_t w = ~((bitstr_word_t) b[word]);
 
-		if (b[word] == BITSTR_MAXPOS) {
-			bit += sizeof(bitstr_t)*8;
+		if (w == 0)
 			continue;
-		}
-		while (bit < _bitstr_bits(b) && _bit_word(bit) == word) {
-			if (!bit_test(b, bit)) {
-				value = bit;
-				break;
-			}
-			bit++;
-		}
+		bit = ((word - BITSTR_OVERHEAD) << BITSTR_SHIFT) + _word_ffs(w);
+		if (bit >= _bitstr_bits(b))
+			break;
+		return bit;
 	}
-	return value;
+	return -1;
 }
 
 /* Find the first n contiguous bits clear in b.
@@ -338,13 +656,33 @@ bitoff_t
 bit_nffc(bitstr_t *b, int32_t n)
 {
 	bitoff_t value = -1;
-	bitoff_t bit;
+	bitoff_t bit, bit_cnt;
 	int32_t cnt = 0;
 
 	_assert_bitstr_valid(b);
 	assert(n > 0 && n < _bitstr_bits(b));
 
-	for (bit = 0; bit < _bitstr_bits(b); bit++) {
+	bit_cnt = _bitstr_bits(b);
+	for (bit = 0; bit < bit_cnt; ) {
+		if (((bit & BITSTR_MAXPOS) == 0) &&
+		    ((bit + _bitstr_word_bits) <= bit_cnt)) {
+			/* Test whole words at a time where possible */
+			bitstr_t w = b[_bit_word(bit)];
+			if (w == 0) {
+				cnt += _bitstr_word_bits;
+				if (cnt >= n) {
+					value = bit + _bitstr_word_bits - cnt;
+					break;
+				}
+				bit += _bitstr_word_bits;
+				continue;
+			}
+			if (w == (bitstr_t) -1) {
+				cnt = 0;
+				bit += _bitstr_word_bits;
+				continue;
+			}
+		}
 		if (bit_test(b, bit)) {		/* fail */
 			cnt = 0;
 		} else {
@@ -354,6 +692,7 @@ bit_nffc(bitstr_t *b, int32_t n)
 				break;
 			}
 		}
+		bit++;
 	}
 
 	return value;
@@ -417,13 +756,35 @@ bitoff_t
 bit_nffs(bitstr_t *b, int32_t n)
 {
 	bitoff_t value = -1;
-	bitoff_t bit;
+	bitoff_t bit, bit_cnt;
 	int32_t cnt = 0;
 
 	_assert_bitstr_valid(b);
 	assert(n > 0 && n <= _bitstr_bits(b));
 
-	for (bit = 0; bit <= _bitstr_bits(b) - n; bit++) {
+	bit_cnt = _bitstr_bits(b);
+	for (bit = 0; bit < bit_cnt; ) {
+		if ((cnt == 0) && (bit > (bit_cnt - n)))
+			break;		/* Not enough bits left */
+		if (((bit & BITSTR_MAXPOS) == 0) &&
+		    ((bit + _bitstr_word_bits) <= bit_cnt)) {
+			/* Test whole words at a time where possible */
+			bitstr_t w = b[_bit_word(bit)];
+			if (w == (bitstr_t) -1) {
+				cnt += _bitstr_word_bits;
+				if (cnt >= n) {
+					value = bit + _bitstr_word_bits - cnt;
+					break;
+				}
+				bit += _bitstr_word_bits;
+				continue;
+			}
+			if (w == 0) {
+				cnt = 0;
+				bit += _bitstr_word_bits;
+				continue;
+			}
+		}
 		if (!bit_test(b, bit)) {	/* fail */
 			cnt = 0;
 		} else {
@@ -433,6 +794,7 @@ bit_nffs(bitstr_t *b, int32_t n)
 				break;
 			}
 		}
+		bit++;
 	}
 
 	return value;
@@ -446,26 +808,21 @@ bit_nffs(bitstr_t *b, int32_t n)
 bitoff_t
 bit_ffs(bitstr_t *b)
 {
-	bitoff_t bit = 0, value = -1;
+	bitoff_t word, word_cnt, bit;
 
 	_assert_bitstr_valid(b);
 
-	while (bit < _bitstr_bits(b) && value == -1) {
-		int32_t word = _bit_word(bit);
-
-		if (b[word] == 0) {
-			bit += sizeof(bitstr_t)*8;
+	word_cnt = _bitstr_words(_bitstr_bits(b));
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++) {
+		if (b[word] == 0)
 			continue;
-		}
-		while (bit < _bitstr_bits(b) && _bit_word(bit) == word) {
-			if (bit_test(b, bit)) {
-				value = bit;
-				break;
-			}
-			bit++;
-		}
+		bit = ((word - BITSTR_OVERHEAD) << BITSTR_SHIFT) +
+		      _word_ffs(b[word]);
+		if (bit >= _bitstr_bits(b))
+			break;
+		return bit;
 	}
-	return value;
+	return -1;
 }
 
 /*
@@ -476,39 +833,27 @@ bit_ffs(bitstr_t *b)
 bitoff_t
 bit_fls(bitstr_t *b)
 {
-	bitoff_t bit, value = -1;
-	int32_t word;
+	bitoff_t word, bit_cnt;
+	bitstr_word_t w;
 
 	_assert_bitstr_valid(b);
 
-	if (_bitstr_bits(b) == 0)	/* empty bitstring */
+	bit_cnt = _bitstr_bits(b);
+	if (bit_cnt == 0)	/* empty bitstring */
 		return -1;
 
-	bit = _bitstr_bits(b) - 1;	/* zero origin */
-
-	while (bit >= 0 && 		/* test partitial words */
-		(_bit_word(bit) == _bit_word(bit + 1))) {
-		if (bit_test(b, bit)) {
-			value = bit;
-			break;
-		}
-		bit--;
-	}
-	while (bit >= 0 && value == -1) {	/* test whole words */
-		word = _bit_word(bit);
-		if (b[word] == 0) {
-			bit -= sizeof(bitstr_t) * 8;
-			continue;
-		}
-		while (bit >= 0) {
-			if (bit_test(b, bit)) {
-				value = bit;
-				break;
-			}
-			bit--;
+	word = _bit_word(bit_cnt - 1);
+	w = b[word] & _tail_mask(bit_cnt);	/* ignore unused bits */
+	while (1) {
+		if (w) {
+			return ((word - BITSTR_OVERHEAD) << BITSTR_SHIFT) +
+			       _word_fls(w);
 		}
+		if (--word < BITSTR_OVERHEAD)
+			break;
+		w = b[word];
 	}
-	return value;
+	return -1;
 }
 
 /*
@@ -538,17 +883,21 @@ bit_fill_gaps(bitstr_t *b)
 int
 bit_super_set(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, word_cnt;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8) {
-		if (b1[_bit_word(bit)] != (b1[_bit_word(bit)] &
-		                           b2[_bit_word(bit)]))
+	if (_bitstr_bits(b1) == 0)
+		return 1;
+	word_cnt = _bitstr_words(_bitstr_bits(b1)) - 1;
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++) {
+		if (b1[word] & ~b2[word])
 			return 0;
 	}
+	if (b1[word] & ~b2[word] & _tail_mask(_bitstr_bits(b1)))
+		return 0;
 
 	return 1;
 }
@@ -559,7 +908,7 @@ bit_super_set(bitstr_t *b1, bitstr_t *b2)
 extern int
 bit_equal(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, word_cnt;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
@@ -567,8 +916,9 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
 	if (_bitstr_bits(b1) != _bitstr_bits(b2))
 		return 0;
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8) {
-		if (b1[_bit_word(bit)] != b2[_bit_word(bit)])
+	word_cnt = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++) {
+		if (b1[word] != b2[word])
 			return 0;
 	}
 
@@ -585,14 +935,35 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
 void
 bit_and(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, word_cnt;
+
+	_assert_bitstr_valid(b1);
+	_assert_bitstr_valid(b2);
+	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
+
+	word_cnt = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++)
+		b1[word] &= b2[word];
+}
+
+/*
+ * b1 &= ~b2, clear in b1 every bit set in b2. This is equivalent to
+ *	bit_not(b2); bit_and(b1, b2); bit_not(b2); without modifying b2
+ *   b1 (IN/OUT)	first bitmap
+ *   b2 (IN)		second bitmap
+ */
+void
+bit_and_not(bitstr_t *b1, bitstr_t *b2)
+{
+	bitoff_t word, word_cnt;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] &= b2[_bit_word(bit)];
+	word_cnt = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++)
+		b1[word] &= ~b2[word];
 }
 
 /*
@@ -602,12 +973,13 @@ bit_and(bitstr_t *b1, bitstr_t *b2)
 void
 bit_not(bitstr_t *b)
 {
-	bitoff_t bit;
+	bitoff_t word, word_cnt;
 
 	_assert_bitstr_valid(b);
 
-	for (bit = 0; bit < _bitstr_bits(b); bit += sizeof(bitstr_t)*8)
-		b[_bit_word(bit)] = ~b[_bit_word(bit)];
+	word_cnt = _bitstr_words(_bitstr_bits(b));
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++)
+		b[word] = ~b[word];
 }
 
 /*
@@ -618,14 +990,15 @@ bit_not(bitstr_t *b)
 void
 bit_or(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
+	bitoff_t word, word_cnt;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] |= b2[_bit_word(bit)];
+	word_cnt = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++)
+		b1[word] |= b2[word];
 }
 
 
@@ -644,7 +1017,7 @@ bit_copy(bitstr_t *b)
 
 	newsize_bits  = bit_size(b);
 	len = (_bitstr_words(newsize_bits) - BITSTR_OVERHEAD)*sizeof(bitstr_t);
-	new = bit_alloc(newsize_bits);
+	new = _bit_alloc(newsize_bits, false);
 	if (new)
 		memcpy(&new[BITSTR_OVERHEAD], &b[BITSTR_OVERHEAD], len);
 
@@ -664,44 +1037,6 @@ bit_copybits(bitstr_t *dest, bitstr_t *src)
 	memcpy(&dest[BITSTR_OVERHEAD], &src[BITSTR_OVERHEAD], len);
 }
 
-#if !defined(USE_64BIT_BITSTR)
-/*
- * Returns the hamming weight (i.e. the number of bits set) in a word.
- * NOTE: This routine borrowed from Linux 2.4.9 <linux/bitops.h>.
- */
-static uint32_t
-hweight(uint32_t w)
-{
-	uint32_t res;
-
-	res = (w   & 0x55555555) + ((w >> 1)    & 0x55555555);
-	res = (res & 0x33333333) + ((res >> 2)  & 0x33333333);
-	res = (res & 0x0F0F0F0F) + ((res >> 4)  & 0x0F0F0F0F);
-	res = (res & 0x00FF00FF) + ((res >> 8)  & 0x00FF00FF);
-	res = (res & 0x0000FFFF) + ((res >> 16) & 0x0000FFFF);
-
-	return res;
-}
-#else
-/*
- * A 64 bit version crafted from 32-bit one borrowed above.
- */
-static uint64_t
-hweight(uint64_t w)
-{
-	uint64_t res;
-
-	res = (w   & 0x5555555555555555) + ((w >> 1)    & 0x5555555555555555);
-	res = (res & 0x3333333333333333) + ((res >> 2)  & 0x3333333333333333);
-	res = (res & 0x0F0F0F0F0F0F0F0F) + ((res >> 4)  & 0x0F0F0F0F0F0F0F0F);
-	res = (res & 0x00FF00FF00FF00FF) + ((res >> 8)  & 0x00FF00FF00FF00FF);
-	res = (res & 0x0000FFFF0000FFFF) + ((res >> 16) & 0x0000FFFF0000FFFF);
-	res = (res & 0x00000000FFFFFFFF) + ((res >> 32) & 0x00000000FFFFFFFF);
-
-	return res;
-}
-#endif /* !USE_64BIT_BITSTR */
-
 /*
  * Count the number of bits set in bitstring.
  *   b (IN)		bitstring to check
@@ -711,19 +1046,17 @@ int32_t
 bit_set_count(bitstr_t *b)
 {
 	int32_t count = 0;
-	bitoff_t bit, bit_cnt;
-	int32_t word_size = sizeof(bitstr_t) * 8;
+	bitoff_t word, word_cnt;
 
 	_assert_bitstr_valid(b);
 
-	bit_cnt = _bitstr_bits(b);
-	for (bit = 0; (bit + word_size) <= bit_cnt; bit += word_size) {
-		count += hweight(b[_bit_word(bit)]);
-	}
-	for ( ; bit < bit_cnt; bit++) {
-		if (bit_test(b, bit))
-			count++;
-	}
+	if (_bitstr_bits(b) == 0)
+		return 0;
+	word_cnt = _bitstr_words(_bitstr_bits(b)) - 1;
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++)
+		count += hweight(b[word]);
+	count += hweight(b[word] & _tail_mask(_bitstr_bits(b)));
+
 	return count;
 }
 
@@ -768,23 +1101,18 @@ extern int32_t
 bit_overlap(bitstr_t *b1, bitstr_t *b2)
 {
 	int32_t count = 0;
-	bitoff_t bit, bit_cnt;
-	int32_t word_size = sizeof(bitstr_t) * 8;
+	bitoff_t word, word_cnt;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	bit_cnt = _bitstr_bits(b1);
-	for (bit = 0; bit < bit_cnt; bit += word_size) {
-		if ((bit + word_size - 1) >= bit_cnt)
-			break;
-		count += hweight(b1[_bit_word(bit)] & b2[_bit_word(bit)]);
-	}
-	for ( ; bit < bit_cnt; bit++) {
-		if (bit_test(b1, bit) && bit_test(b2, bit))
-			count++;
-	}
+	if (_bitstr_bits(b1) == 0)
+		return 0;
+	word_cnt = _bitstr_words(_bitstr_bits(b1)) - 1;
+	for (word = BITSTR_OVERHEAD; word < word_cnt; word++)
+		count += hweight(b1[word] & b2[word]);
+	count += hweight(b1[word] & b2[word] & _tail_mask(_bitstr_bits(b1)));
 
 	return count;
 }
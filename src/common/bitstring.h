@@ -120,9 +120,13 @@ bitoff_t bit_nffs(bitstr_t *b, int32_t n);
 bitoff_t bit_nffc(bitstr_t *b, int32_t n);
 bitoff_t bit_noc(bitstr_t *b, int32_t n, int32_t seed);
 void	bit_free(bitstr_t *b);
+void	bit_cache_begin(void);
+void	bit_cache_end(void);
+void	bit_cache_fini(void);
 bitstr_t *bit_realloc(bitstr_t *b, bitoff_t nbits);
 bitoff_t bit_size(bitstr_t *b);
 void	bit_and(bitstr_t *b1, bitstr_t *b2);
+void	bit_and_not(bitstr_t *b1, bitstr_t *b2);
 void	bit_not(bitstr_t *b);
 void	bit_or(bitstr_t *b1, bitstr_t *b2);
 int32_t	bit_set_count(bitstr_t *b);
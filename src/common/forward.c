@@ -63,6 +63,23 @@
 
 #define MAX_RETRIES 3
 
+/* Nodes which recently failed to accept a connection are not picked as
+ * the head of a subtree for FWD_FAIL_TTL seconds, so a down node only
+ * delays its own message rather than every node below it in the tree.
+ * Entries are direct mapped by a hash of the node name, a collision
+ * only makes a healthy node a less preferred head. */
+#define FWD_FAIL_CACHE_SIZE 1024
+#define FWD_FAIL_TTL 60
+
+typedef struct {
+	uint32_t hash;
+	time_t fail_time;	/* 0 if unused */
+} fwd_fail_t;
+
+static fwd_fail_t fwd_fail_cache[FWD_FAIL_CACHE_SIZE];
+static int fwd_fail_cnt = 0;	/* entries in use */
+static pthread_mutex_t fwd_fail_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 typedef struct {
 	pthread_cond_t *notify;
 	int            *p_thr_count;
@@ -73,6 +90,70 @@ typedef struct {
 	pthread_mutex_t *tree_mutex;
 } fwd_tree_t;
 
+static uint32_t _fwd_name_hash(const char *name)
+{
+	uint32_t hash = 5381;
+
+	while (*name)
+		hash = (hash * 33) + (unsigned char) *name++;
+	return hash;
+}
+
+/* Note whether a connection to node name failed or succeeded */
+static void _fwd_fail_record(const char *name, bool failed)
+{
+	uint32_t hash = _fwd_name_hash(name);
+	fwd_fail_t *ent = &fwd_fail_cache[hash % FWD_FAIL_CACHE_SIZE];
+
+	slurm_mutex_lock(&fwd_fail_mutex);
+	if (failed) {
+		if (!ent->fail_time)
+			fwd_fail_cnt++;
+		ent->hash = hash;
+		ent->fail_time = time(NULL);
+	} else if (ent->fail_time && (ent->hash == hash)) {
+		ent->fail_time = 0;
+		fwd_fail_cnt--;
+	}
+	slurm_mutex_unlock(&fwd_fail_mutex);
+}
+
+/* Remove and return the first host of hl which has not failed in the
+ * last FWD_FAIL_TTL seconds, or the first host if they all have.
+ * The return value must be released with free() */
+static char *_fwd_next_head(hostlist_t hl)
+{
+	hostlist_iterator_t itr;
+	fwd_fail_t *ent;
+	uint32_t hash;
+	char *name = NULL;
+	time_t now;
+
+	slurm_mutex_lock(&fwd_fail_mutex);
+	if (fwd_fail_cnt == 0) {
+		slurm_mutex_unlock(&fwd_fail_mutex);
+		return hostlist_shift(hl);
+	}
+
+	now = time(NULL);
+	itr = hostlist_iterator_create(hl);
+	while ((name = hostlist_next(itr))) {
+		hash = _fwd_name_hash(name);
+		ent = &fwd_fail_cache[hash % FWD_FAIL_CACHE_SIZE];
+		if (!ent->fail_time || (ent->hash != hash) ||
+		    (difftime(now, ent->fail_time) >= FWD_FAIL_TTL))
+			break;
+		free(name);
+	}
+	hostlist_iterator_destroy(itr);
+	slurm_mutex_unlock(&fwd_fail_mutex);
+
+	if (!name)
+		return hostlist_shift(hl);
+	hostlist_delete_host(hl, name);
+	return name;
+}
+
 void _destroy_tree_fwd(fwd_tree_t *fwd_tree)
 {
 	if (fwd_tree) {
@@ -107,7 +188,7 @@ void *_forward_thread(void *arg)
 	int start_timeout = fwd_msg->timeout;
 
 	/* repeat until we are sure the message was sent */
-	while ((name = hostlist_shift(hl))) {
+	while ((name = _fwd_next_head(hl))) {
 		if (slurm_conf_get_addr(name, &addr) == SLURM_ERROR) {
 			error("forward_thread: can't find address for host "
 			      "%s, check slurm.conf", name);
@@ -123,6 +204,7 @@ void *_forward_thread(void *arg)
 		}
 		if ((fd = slurm_open_msg_conn(&addr)) < 0) {
 			error("forward_thread to %s: %m", name);
+			_fwd_fail_record(name, true);
 
 			slurm_mutex_lock(fwd_msg->forward_mutex);
 			mark_as_failed_forward(
@@ -323,15 +405,17 @@ void *_fwd_tree_thread(void *arg)
 	List ret_list = NULL;
 	char *name = NULL;
 	char *buf = NULL;
+	int send_errno;
 	slurm_msg_t send_msg;
 
 	slurm_msg_t_init(&send_msg);
 	send_msg.msg_type = fwd_tree->orig_msg->msg_type;
 	send_msg.data = fwd_tree->orig_msg->data;
 	send_msg.protocol_version = fwd_tree->orig_msg->protocol_version;
+	send_msg.send_auth_cred = fwd_tree->orig_msg->send_auth_cred;
 
 	/* repeat until we are sure the message was sent */
-	while ((name = hostlist_shift(fwd_tree->tree_hl))) {
+	while ((name = _fwd_next_head(fwd_tree->tree_hl))) {
 		if (slurm_conf_get_addr(name, &send_msg.address)
 		    == SLURM_ERROR) {
 			error("fwd_tree_thread: can't find address for host "
@@ -362,6 +446,12 @@ void *_fwd_tree_thread(void *arg)
 
 		ret_list = slurm_send_addr_recv_msgs(&send_msg, name,
 						     fwd_tree->timeout);
+		/* errno may be changed by the list and mutex calls below */
+		send_errno = errno;
+		/* Any retry goes to hosts which may already have received
+		 * the shared credential through the failed head, and would
+		 * reject it as a replay. Pack a new one for each retry. */
+		send_msg.send_auth_cred = NULL;
 
 		xfree(send_msg.forward.nodelist);
 
@@ -402,6 +492,9 @@ void *_fwd_tree_thread(void *arg)
 			list_destroy(ret_list);
 			/* try next node */
 			if (ret_cnt <= send_msg.forward.cnt) {
+				if (send_errno ==
+				    SLURM_COMMUNICATIONS_CONNECTION_ERROR)
+					_fwd_fail_record(name, true);
 				free(name);
 				continue;
 			}
@@ -423,12 +516,15 @@ void *_fwd_tree_thread(void *arg)
 			continue;
 		}
 
-		free(name);
-
 		/* check for error and try again */
-		if (errno == SLURM_COMMUNICATIONS_CONNECTION_ERROR)
+		if (send_errno == SLURM_COMMUNICATIONS_CONNECTION_ERROR) {
+			_fwd_fail_record(name, true);
+			free(name);
  			continue;
+		}
 
+		_fwd_fail_record(name, false);
+		free(name);
 		break;
 	}
 
@@ -85,11 +85,12 @@ typedef struct sbcast_cred sbcast_cred_t;		/* opaque data type */
  * slurm job credential state
  *
  */
-typedef struct {
+typedef struct cred_state {
 	time_t   ctime;		/* Time that the cred was created	*/
 	time_t   expiration;    /* Time at which cred is no longer good	*/
 	uint32_t jobid;		/* SLURM job id for this credential	*/
 	uint32_t stepid;	/* SLURM step id for this credential	*/
+	struct cred_state *next;/* next entry in ctx->state_hash bucket */
 } cred_state_t;
 
 /*
@@ -97,13 +98,24 @@ typedef struct {
  * tracks jobids for which all future credentials have been revoked
  *
  */
-typedef struct {
+typedef struct job_state {
 	time_t   ctime;         /* Time that this entry was created         */
 	time_t   expiration;    /* Time at which credentials can be purged  */
 	uint32_t jobid;         /* SLURM job id for this credential	*/
 	time_t   revoked;       /* Time at which credentials were revoked   */
+	struct job_state *next; /* next entry in ctx->job_hash bucket       */
 } job_state_t;
 
+/*
+ * Every credential a slurmd verifies is checked against job_list and
+ * state_list, so both are also indexed by hash tables of this size.
+ */
+#define CRED_HASH_SIZE	4096
+#define JOB_STATE_HASH_INX(_jobid)	((_jobid) % CRED_HASH_SIZE)
+#define CRED_STATE_HASH_INX(_jobid, _stepid, _ctime)			\
+	(((_jobid) ^ ((_stepid) * 2654435761U) ^ (uint32_t) (_ctime))	\
+	 % CRED_HASH_SIZE)
+
 
 /*
  * Completion of slurm credential context
@@ -141,6 +153,9 @@ struct slurm_cred_context {
 	void          *key;        /* private or public key                 */
 	List           job_list;   /* List of used jobids (for verifier)    */
 	List           state_list; /* List of cred states (for verifier)    */
+	job_state_t  **job_hash;   /* job_list entries hashed by jobid      */
+	cred_state_t **state_hash; /* state_list entries hashed by
+				    * jobid, stepid and ctime               */
 
 	int          expiry_window;/* expiration window for cached creds    */
 
@@ -253,6 +268,10 @@ static void           _job_state_destroy(job_state_t   *js);
 static job_state_t  * _find_job_state(slurm_cred_ctx_t ctx, uint32_t jobid);
 static job_state_t  * _insert_job_state(slurm_cred_ctx_t ctx,  uint32_t jobid);
 static int            _find_cred_state(cred_state_t *c, slurm_cred_t *cred);
+static void _job_state_hash_add(slurm_cred_ctx_t ctx, job_state_t *j);
+static void _job_state_hash_remove(slurm_cred_ctx_t ctx, job_state_t *j);
+static void _cred_state_hash_add(slurm_cred_ctx_t ctx, cred_state_t *s);
+static void _cred_state_hash_remove(slurm_cred_ctx_t ctx, cred_state_t *s);
 
 static void _insert_cred_state(slurm_cred_ctx_t ctx, slurm_cred_t *cred);
 static void _clear_expired_job_states(slurm_cred_ctx_t ctx);
@@ -424,6 +443,8 @@ slurm_cred_ctx_destroy(slurm_cred_ctx_t ctx)
 		list_destroy(ctx->job_list);
 	if (ctx->state_list)
 		list_destroy(ctx->state_list);
+	xfree(ctx->job_hash);
+	xfree(ctx->state_hash);
 
 	xassert(ctx->magic = ~CRED_CTX_MAGIC);
 
@@ -940,6 +961,7 @@ int
 slurm_cred_rewind(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 {
 	int rc = 0;
+	cred_state_t *s, *s_next;
 
 	xassert(ctx != NULL);
 
@@ -948,6 +970,13 @@ slurm_cred_rewind(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 	xassert(ctx->magic == CRED_CTX_MAGIC);
 	xassert(ctx->type  == SLURM_CRED_VERIFIER);
 
+	s = ctx->state_hash[CRED_STATE_HASH_INX(cred->jobid, cred->stepid,
+						cred->ctime)];
+	for ( ; s; s = s_next) {
+		s_next = s->next;
+		if (_find_cred_state(s, cred))
+			_cred_state_hash_remove(ctx, s);
+	}
 	rc = list_delete_all(ctx->state_list,
 			     (ListFindF) _find_cred_state, cred);
 
@@ -1494,6 +1523,8 @@ _verifier_ctx_init(slurm_cred_ctx_t ctx)
 
 	ctx->job_list   = list_create((ListDelF) _job_state_destroy);
 	ctx->state_list = list_create((ListDelF) _cred_state_destroy);
+	ctx->job_hash   = xmalloc(sizeof(job_state_t *) * CRED_HASH_SIZE);
+	ctx->state_hash = xmalloc(sizeof(cred_state_t *) * CRED_HASH_SIZE);
 
 	return;
 }
@@ -1769,21 +1800,14 @@ _pack_cred(slurm_cred_t *cred, Buf buffer, uint16_t protocol_version)
 static bool
 _credential_replayed(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 {
-	ListIterator  i = NULL;
 	cred_state_t *s = NULL;
 
 	_clear_expired_credential_states(ctx);
 
-	i = list_iterator_create(ctx->state_list);
-
-	while ((s = list_next(i))) {
-		if ((s->jobid  == cred->jobid)  &&
-		    (s->stepid == cred->stepid) &&
-		    (s->ctime  == cred->ctime))
-			break;
-	}
-
-	list_iterator_destroy(i);
+	s = ctx->state_hash[CRED_STATE_HASH_INX(cred->jobid, cred->stepid,
+						cred->ctime)];
+	while (s && !_find_cred_state(s, cred))
+		s = s->next;
 
 	/*
 	 * If we found a match, this credential is being replayed.
@@ -1883,18 +1907,55 @@ _credential_revoked(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 static job_state_t *
 _find_job_state(slurm_cred_ctx_t ctx, uint32_t jobid)
 {
-	ListIterator  i = NULL;
-	job_state_t  *j = NULL;
+	job_state_t  *j = ctx->job_hash[JOB_STATE_HASH_INX(jobid)];
 
-	i = list_iterator_create(ctx->job_list);
-	while ((j = list_next(i))) {
-		if (j->jobid == jobid)
-			break;
-	}
-	list_iterator_destroy(i);
+	while (j && (j->jobid != jobid))
+		j = j->next;
 	return j;
 }
 
+static void
+_job_state_hash_add(slurm_cred_ctx_t ctx, job_state_t *j)
+{
+	int inx = JOB_STATE_HASH_INX(j->jobid);
+
+	j->next = ctx->job_hash[inx];
+	ctx->job_hash[inx] = j;
+}
+
+static void
+_job_state_hash_remove(slurm_cred_ctx_t ctx, job_state_t *j)
+{
+	job_state_t **jp = &ctx->job_hash[JOB_STATE_HASH_INX(j->jobid)];
+
+	while (*jp && (*jp != j))
+		jp = &(*jp)->next;
+	if (*jp)
+		*jp = j->next;
+}
+
+static void
+_cred_state_hash_add(slurm_cred_ctx_t ctx, cred_state_t *s)
+{
+	int inx = CRED_STATE_HASH_INX(s->jobid, s->stepid, s->ctime);
+
+	s->next = ctx->state_hash[inx];
+	ctx->state_hash[inx] = s;
+}
+
+static void
+_cred_state_hash_remove(slurm_cred_ctx_t ctx, cred_state_t *s)
+{
+	cred_state_t **sp;
+
+	sp = &ctx->state_hash[CRED_STATE_HASH_INX(s->jobid, s->stepid,
+						  s->ctime)];
+	while (*sp && (*sp != s))
+		sp = &(*sp)->next;
+	if (*sp)
+		*sp = s->next;
+}
+
 static int
 _find_cred_state(cred_state_t *c, slurm_cred_t *cred)
 {
@@ -1907,6 +1968,7 @@ _insert_job_state(slurm_cred_ctx_t ctx, uint32_t jobid)
 {
 	job_state_t *j = _job_state_create(jobid);
 	list_append(ctx->job_list, j);
+	_job_state_hash_add(ctx, j);
 	return j;
 }
 
@@ -1969,6 +2031,7 @@ _clear_expired_job_states(slurm_cred_ctx_t ctx)
 		       (uint64_t)j->revoked);
 #endif
 		if (j->revoked && (now > j->expiration)) {
+			_job_state_hash_remove(ctx, j);
 			list_delete_item(i);
 		}
 	}
@@ -1991,8 +2054,10 @@ _clear_expired_credential_states(slurm_cred_ctx_t ctx)
 
 	i = list_iterator_create(ctx->state_list);
 	while ((s = list_next(i))) {
-		if (now > s->expiration)
+		if (now > s->expiration) {
+			_cred_state_hash_remove(ctx, s);
 			list_delete_item(i);
+		}
 	}
 	list_iterator_destroy(i);
 }
@@ -2003,6 +2068,7 @@ _insert_cred_state(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 {
 	cred_state_t *s = _cred_state_create(ctx, cred);
 	list_append(ctx->state_list, s);
+	_cred_state_hash_add(ctx, s);
 }
 
 
@@ -2132,9 +2198,10 @@ _cred_state_unpack(slurm_cred_ctx_t ctx, Buf buffer)
 		if (!(s = _cred_state_unpack_one(buffer)))
 			goto unpack_error;
 
-		if (now < s->expiration)
+		if (now < s->expiration) {
 			list_append(ctx->state_list, s);
-		else
+			_cred_state_hash_add(ctx, s);
+		} else
 			_cred_state_destroy(s);
 	}
 
@@ -2176,9 +2243,10 @@ _job_state_unpack(slurm_cred_ctx_t ctx, Buf buffer)
 		if (!(j = _job_state_unpack_one(buffer)))
 			goto unpack_error;
 
-		if (!j->revoked || (j->revoked && (now < j->expiration)))
+		if (!j->revoked || (j->revoked && (now < j->expiration))) {
 			list_append(ctx->job_list, j);
-		else {
+			_job_state_hash_add(ctx, j);
+		} else {
 			debug3 ("not appending expired job %u state",
 			        j->jobid);
 			_job_state_destroy(j);
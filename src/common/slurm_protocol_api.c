@@ -3277,7 +3277,9 @@ int slurm_send_node_msg(slurm_fd_t fd, slurm_msg_t * msg)
 	 * but we may need to generate the credential again later if we
 	 * wait too long for the incoming message.
 	 */
-	if (msg->flags & SLURM_GLOBAL_AUTH_KEY)
+	if (msg->send_auth_cred)
+		auth_cred = msg->send_auth_cred;
+	else if (msg->flags & SLURM_GLOBAL_AUTH_KEY)
 		auth_cred = g_slurm_auth_create(NULL, 2, _global_auth_key());
 	else
 		auth_cred = g_slurm_auth_create(NULL, 2, slurm_get_auth_info());
@@ -3288,7 +3290,9 @@ int slurm_send_node_msg(slurm_fd_t fd, slurm_msg_t * msg)
 	}
 	forward_wait(msg);
 
-	if (difftime(time(NULL), start_time) >= 60) {
+	/* A shared credential is kept fresh by its owner */
+	if (!msg->send_auth_cred &&
+	    (difftime(time(NULL), start_time) >= 60)) {
 		(void) g_slurm_auth_destroy(auth_cred);
 		if (msg->flags & SLURM_GLOBAL_AUTH_KEY) {
 			auth_cred = g_slurm_auth_create(NULL, 2,
@@ -3316,13 +3320,16 @@ int slurm_send_node_msg(slurm_fd_t fd, slurm_msg_t * msg)
 	 * Pack auth credential
 	 */
 	rc = g_slurm_auth_pack(auth_cred, buffer);
-	(void) g_slurm_auth_destroy(auth_cred);
 	if (rc) {
 		error("authentication: %s",
 		      g_slurm_auth_errstr(g_slurm_auth_errno(auth_cred)));
+		if (!msg->send_auth_cred)
+			(void) g_slurm_auth_destroy(auth_cred);
 		free_buf(buffer);
 		slurm_seterrno_ret(SLURM_PROTOCOL_AUTHENTICATION_ERROR);
 	}
+	if (!msg->send_auth_cred)
+		(void) g_slurm_auth_destroy(auth_cred);
 
 	/*
 	 * Pack message into buffer
@@ -434,6 +434,11 @@ typedef struct slurm_msg {
 	forward_struct_t *forward_struct;
 	slurm_addr_t orig_addr;
 	List ret_list;
+	void *send_auth_cred;	/* if set, credential packed by
+				 * slurm_send_node_msg() instead of creating
+				 * a new one.  Owned by the caller.  Only
+				 * share it between messages to different
+				 * nodes, munge rejects replayed creds. */
 } slurm_msg_t;
 
 typedef struct ret_data_info {
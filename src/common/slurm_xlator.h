@@ -90,6 +90,7 @@
 #define	bit_realloc		slurm_bit_realloc
 #define	bit_size		slurm_bit_size
 #define	bit_and			slurm_bit_and
+#define	bit_and_not		slurm_bit_and_not
 #define	bit_not			slurm_bit_not
 #define	bit_or			slurm_bit_or
 #define	bit_set_count		slurm_bit_set_count
@@ -115,6 +116,9 @@
 #define bit_noc			slurm_bit_noc
 #define bit_nffs		slurm_bit_nffs
 #define bit_copybits		slurm_bit_copybits
+#define bit_cache_begin		slurm_bit_cache_begin
+#define bit_cache_end		slurm_bit_cache_end
+#define bit_cache_fini		slurm_bit_cache_fini
 
 /* fd.[ch] functions */
 #define fd_read_n		slurm_fd_read_n
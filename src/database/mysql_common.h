@@ -76,6 +76,8 @@ typedef struct {
 	pthread_mutex_t lock;
 	char *pre_commit_query;
 	bool rollback;
+	unsigned long trans_conn_id; /* server connection id when the
+				      * current transaction began */
 	List update_list;
 	int conn;
 } mysql_conn_t;
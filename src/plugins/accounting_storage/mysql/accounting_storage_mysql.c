@@ -2171,6 +2171,7 @@ extern int fini ( void )
 	destroy_mysql_db_info(mysql_db_info);
 	xfree(mysql_db_name);
 	xfree(default_qos_str);
+	as_mysql_job_cache_fini();
 	mysql_db_cleanup();
 	return SLURM_SUCCESS;
 }
@@ -2196,8 +2197,10 @@ extern void *acct_storage_p_get_connection(const slurm_trigger_callbacks_t *cb,
 	errno = SLURM_SUCCESS;
 	mysql_db_get_db_connection(mysql_conn, mysql_db_name, mysql_db_info);
 
-	if (mysql_conn->db_conn)
+	if (mysql_conn->db_conn) {
+		mysql_conn->trans_conn_id = mysql_thread_id(mysql_conn->db_conn);
 		errno = SLURM_SUCCESS;
+	}
 
 	return (void *)mysql_conn;
 }
@@ -2219,6 +2222,7 @@ extern int acct_storage_p_close_connection(mysql_conn_t **mysql_conn)
 extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 {
 	int rc = check_connection(mysql_conn);
+	int commit_rc = SLURM_SUCCESS;
 	/* always reset this here */
 	mysql_conn->cluster_deleted = 0;
 	if ((rc != SLURM_SUCCESS) && (rc != ESLURM_CLUSTER_DELETED))
@@ -2227,6 +2231,19 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 	debug4("got %d commits", list_count(mysql_conn->update_list));
 
 	if (mysql_conn->rollback) {
+		unsigned long conn_id = mysql_thread_id(mysql_conn->db_conn);
+
+		/* If we reconnected since the transaction began, the
+		   server already rolled back everything done before
+		   the reconnect. Let the caller know so it can redo it.
+		*/
+		if (commit && (conn_id != mysql_conn->trans_conn_id)) {
+			error("lost connection to the database, changes "
+			      "since the last commit were discarded");
+			commit_rc = ESLURM_DB_CONNECTION;
+		}
+		mysql_conn->trans_conn_id = conn_id;
+
 		if (!commit) {
 			if (mysql_db_rollback(mysql_conn))
 				error("rollback failed");
@@ -2250,11 +2267,14 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 			if (rc != SLURM_SUCCESS) {
 				if (mysql_db_rollback(mysql_conn))
 					error("rollback failed");
-			} else {
-				if (mysql_db_commit(mysql_conn))
-					error("commit failed");
+				commit_rc = rc;
+			} else if (mysql_db_commit(mysql_conn)) {
+				error("commit failed");
+				commit_rc = SLURM_ERROR;
 			}
 		}
+		as_mysql_job_cache_commit(
+			mysql_conn, commit && (commit_rc == SLURM_SUCCESS));
 	}
 
 	if (commit && list_count(mysql_conn->update_list)) {
@@ -2324,7 +2344,7 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 	xfree(mysql_conn->pre_commit_query);
 	list_flush(mysql_conn->update_list);
 
-	return SLURM_SUCCESS;
+	return commit_rc;
 }
 
 extern int acct_storage_p_add_users(mysql_conn_t *mysql_conn, uint32_t uid,
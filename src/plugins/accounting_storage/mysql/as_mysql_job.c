@@ -47,6 +47,114 @@
 #include "src/common/slurm_jobacct_gather.h"
 
 #define BUFFER_SIZE 4096
+#define DB_INDEX_CACHE_SIZE 4096
+
+/* Database indexes of recently added jobs. Step and job completion
+ * records sent before slurmctld learned a job's db_index (common with
+ * short jobs) look the index up here instead of querying for it.
+ * An entry added inside a transaction is only visible to the connection
+ * which added it, and only while that connection has not been
+ * re-established, until as_mysql_job_cache_commit() is called when the
+ * transaction is committed or rolled back. */
+typedef struct {
+	char *cluster;
+	uint32_t jobid;
+	uint32_t associd;
+	time_t submit;
+	int db_index;
+	mysql_conn_t *pending;	/* connection whose transaction added
+				 * this entry, NULL once committed */
+	unsigned long conn_id;	/* server connection id of pending */
+} db_index_cache_t;
+
+static db_index_cache_t db_index_cache[DB_INDEX_CACHE_SIZE];
+static pthread_mutex_t db_index_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void _cache_db_index(mysql_conn_t *mysql_conn, time_t submit,
+			    uint32_t jobid, uint32_t associd, int db_index)
+{
+	db_index_cache_t *entry = &db_index_cache[jobid % DB_INDEX_CACHE_SIZE];
+	char *cluster = mysql_conn->cluster_name;
+
+	if (!db_index || !cluster || !mysql_conn->db_conn)
+		return;
+
+	slurm_mutex_lock(&db_index_cache_lock);
+	if (!entry->cluster || strcmp(entry->cluster, cluster)) {
+		xfree(entry->cluster);
+		entry->cluster = xstrdup(cluster);
+	}
+	entry->jobid = jobid;
+	entry->associd = associd;
+	entry->submit = submit;
+	entry->db_index = db_index;
+	if (mysql_conn->rollback) {
+		entry->pending = mysql_conn;
+		entry->conn_id = mysql_thread_id(mysql_conn->db_conn);
+	} else
+		entry->pending = NULL;
+	slurm_mutex_unlock(&db_index_cache_lock);
+}
+
+static int _find_cached_db_index(mysql_conn_t *mysql_conn, time_t submit,
+				 uint32_t jobid, uint32_t associd)
+{
+	db_index_cache_t *entry = &db_index_cache[jobid % DB_INDEX_CACHE_SIZE];
+	char *cluster = mysql_conn->cluster_name;
+	int db_index = 0;
+
+	if (!cluster || !mysql_conn->db_conn)
+		return 0;
+
+	slurm_mutex_lock(&db_index_cache_lock);
+	if (entry->cluster && (entry->jobid == jobid) &&
+	    (entry->associd == associd) && (entry->submit == submit) &&
+	    !strcmp(entry->cluster, cluster) &&
+	    (!entry->pending ||
+	     ((entry->pending == mysql_conn) &&
+	      (entry->conn_id == mysql_thread_id(mysql_conn->db_conn)))))
+		db_index = entry->db_index;
+	slurm_mutex_unlock(&db_index_cache_lock);
+
+	return db_index;
+}
+
+/* Called when a connection's transaction ends. If it was committed, its
+ * cached database indexes become visible to every connection, otherwise
+ * (rolled back, or the connection was lost before the commit) they are
+ * discarded since those rows no longer exist. */
+extern void as_mysql_job_cache_commit(mysql_conn_t *mysql_conn,
+				      bool committed)
+{
+	db_index_cache_t *entry;
+	int i;
+
+	slurm_mutex_lock(&db_index_cache_lock);
+	for (i = 0, entry = db_index_cache; i < DB_INDEX_CACHE_SIZE;
+	     i++, entry++) {
+		if (entry->pending != mysql_conn)
+			continue;
+		if (committed) {
+			entry->pending = NULL;
+		} else {
+			xfree(entry->cluster);
+			memset(entry, 0, sizeof(db_index_cache_t));
+		}
+	}
+	slurm_mutex_unlock(&db_index_cache_lock);
+}
+
+extern void as_mysql_job_cache_fini(void)
+{
+	int i;
+
+	slurm_mutex_lock(&db_index_cache_lock);
+	for (i = 0; i < DB_INDEX_CACHE_SIZE; i++) {
+		xfree(db_index_cache[i].cluster);
+		memset(&db_index_cache[i], 0, sizeof(db_index_cache_t));
+	}
+	slurm_mutex_unlock(&db_index_cache_lock);
+}
 
 /* Used in job functions for getting the database index based off the
  * submit time, job and assoc id.  0 is returned if none is found
@@ -57,11 +165,17 @@ static int _get_db_index(mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 	MYSQL_ROW row;
 	int db_index = 0;
-	char *query = xstrdup_printf("select job_db_inx from \"%s_%s\" where "
-				     "time_submit=%d and id_job=%u "
-				     "and id_assoc=%u",
-				     mysql_conn->cluster_name, job_table,
-				     (int)submit, jobid, associd);
+	char *query;
+
+	if ((db_index = _find_cached_db_index(mysql_conn, submit, jobid,
+					      associd)))
+		return db_index;
+
+	query = xstrdup_printf("select job_db_inx from \"%s_%s\" where "
+			       "time_submit=%d and id_job=%u "
+			       "and id_assoc=%u",
+			       mysql_conn->cluster_name, job_table,
+			       (int)submit, jobid, associd);
 
 	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
 		xfree(query);
@@ -81,6 +195,7 @@ static int _get_db_index(mysql_conn_t *mysql_conn,
 	}
 	db_index = slurm_atoul(row[0]);
 	mysql_free_result(result);
+	_cache_db_index(mysql_conn, submit, jobid, associd, db_index);
 
 	return db_index;
 }
@@ -584,6 +699,10 @@ no_rollup_change:
 				goto try_again;
 			} else
 				rc = SLURM_ERROR;
+		} else {
+			_cache_db_index(mysql_conn, submit_time,
+					job_ptr->job_id, job_ptr->assoc_id,
+					job_ptr->db_index);
 		}
 	} else {
 		query = xstrdup_printf("update \"%s_%s\" set nodelist='%s', ",
@@ -41,9 +41,11 @@
 #include "as_mysql_rollup.h"
 #include "as_mysql_archive.h"
 #include "src/common/parse_time.h"
+#include "src/common/xhash.h"
 
 typedef struct {
 	int id;
+	char key[11]; /* id as a string, used as the xhash key */
 	uint64_t a_cpu;
 	uint64_t energy;
 } local_id_usage_t;
@@ -81,6 +83,36 @@ static void _destroy_local_id_usage(void *object)
 	}
 }
 
+/* identity function for the local_id_usage_t hash tables */
+static const char *_local_id_usage_key(void *item)
+{
+	local_id_usage_t *usage = (local_id_usage_t *)item;
+	return usage->key;
+}
+
+/* Return the usage record for id, creating it and adding it to both
+ * the list and the hash if it doesn't exist yet.  This replaces linear
+ * scans of the list which made the hourly rollup quadratic in the
+ * number of wckeys and reservation associations. */
+static local_id_usage_t *_get_local_id_usage(List usage_list,
+					     xhash_t *usage_hash, int id)
+{
+	local_id_usage_t *usage;
+	char key[11];
+
+	snprintf(key, sizeof(key), "%d", id);
+	if ((usage = xhash_get(usage_hash, key)))
+		return usage;
+
+	usage = xmalloc(sizeof(local_id_usage_t));
+	usage->id = id;
+	memcpy(usage->key, key, sizeof(key));
+	list_append(usage_list, usage);
+	xhash_add(usage_hash, usage);
+
+	return usage;
+}
+
 static void _destroy_local_cluster_usage(void *object)
 {
 	local_cluster_usage_t *c_usage = (local_cluster_usage_t *)object;
@@ -478,6 +510,11 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	List assoc_usage_list = list_create(_destroy_local_id_usage);
 	List cluster_down_list = list_create(_destroy_local_cluster_usage);
 	List wckey_usage_list = list_create(_destroy_local_id_usage);
+	/* The hashes only index the items, the lists own them. */
+	xhash_t *assoc_usage_hash = xhash_init(_local_id_usage_key,
+					       NULL, NULL, 0);
+	xhash_t *wckey_usage_hash = xhash_init(_local_id_usage_key,
+					       NULL, NULL, 0);
 	List resv_usage_list = list_create(_destroy_local_resv_usage);
 	uint16_t track_wckey = slurm_get_track_wckey();
 	/* char start_char[20], end_char[20]; */
@@ -806,9 +843,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			}
 
 			if (last_id != assoc_id) {
-				a_usage = xmalloc(sizeof(local_id_usage_t));
-				a_usage->id = assoc_id;
-				list_append(assoc_usage_list, a_usage);
+				a_usage = _get_local_id_usage(
+					assoc_usage_list, assoc_usage_hash,
+					assoc_id);
 				last_id = assoc_id;
 			}
 
@@ -820,19 +857,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 			/* do the wckey calculation */
 			if (last_wckeyid != wckey_id) {
-				list_iterator_reset(w_itr);
-				while ((w_usage = list_next(w_itr)))
-					if (w_usage->id == wckey_id)
-						break;
-
-				if (!w_usage) {
-					w_usage = xmalloc(
-						sizeof(local_id_usage_t));
-					w_usage->id = wckey_id;
-					list_append(wckey_usage_list,
-						    w_usage);
-				}
-
+				w_usage = _get_local_id_usage(
+					wckey_usage_list, wckey_usage_hash,
+					wckey_id);
 				last_wckeyid = wckey_id;
 			}
 			w_usage->a_cpu += seconds * row_acpu;
@@ -997,21 +1024,10 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			tmp_itr = list_iterator_create(r_usage->local_assocs);
 			while ((assoc = list_next(tmp_itr))) {
 				uint32_t associd = slurm_atoul(assoc);
-				if (last_id != associd) {
-					list_iterator_reset(a_itr);
-					while ((a_usage = list_next(a_itr))) {
-						if (a_usage->id == associd) {
-							last_id = a_usage->id;
-							break;
-						}
-					}
-				}
-
-				if (!a_usage) {
-					a_usage = xmalloc(
-						sizeof(local_id_usage_t));
-					a_usage->id = associd;
-					list_append(assoc_usage_list, a_usage);
+				if (!a_usage || (last_id != associd)) {
+					a_usage = _get_local_id_usage(
+						assoc_usage_list,
+						assoc_usage_hash, associd);
 					last_id = associd;
 				}
 
@@ -1132,6 +1148,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 	end_loop:
 		_destroy_local_cluster_usage(c_usage);
+		xhash_clear(assoc_usage_hash);
+		xhash_clear(wckey_usage_hash);
 		list_flush(assoc_usage_list);
 		list_flush(cluster_down_list);
 		list_flush(wckey_usage_list);
@@ -1148,6 +1166,8 @@ end_it:
 	list_iterator_destroy(w_itr);
 	list_iterator_destroy(r_itr);
 
+	xhash_free(assoc_usage_hash);
+	xhash_free(wckey_usage_hash);
 	list_destroy(assoc_usage_list);
 	list_destroy(cluster_down_list);
 	list_destroy(wckey_usage_list);
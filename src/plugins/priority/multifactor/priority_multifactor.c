@@ -423,6 +423,40 @@ static void _ticket_based_set_usage_efctv(slurmdb_association_rec_t *assoc)
 }
 
 
+/* Set the normalized usage of an account's children and record their sum,
+ * which _depth_oblivious_set_usage_efctv() needs for each of them. Users'
+ * effective usage is only calculated on demand, so summing the siblings
+ * there would otherwise cost O(n^2) over an account with n users.
+ *
+ * NOTE: acct_mgr_association_lock must be locked before this is called.
+ */
+static void _set_children_usage_norm(slurmdb_association_rec_t *parent)
+{
+	slurmdb_association_rec_t *assoc;
+	ListIterator itr;
+	long double root_usage = assoc_mgr_root_assoc->usage->usage_raw;
+	long double sum = 0;
+
+	if (!parent->usage->children_list)
+		return;
+
+	itr = list_iterator_create(parent->usage->children_list);
+	while ((assoc = list_next(itr))) {
+		if (root_usage)
+			assoc->usage->usage_norm =
+				assoc->usage->usage_raw / root_usage;
+		else
+			assoc->usage->usage_norm = 0;
+		if (assoc->usage->usage_norm > 1.0)
+			assoc->usage->usage_norm = 1.0;
+		if (assoc->shares_raw != SLURMDB_FS_USE_PARENT)
+			sum += assoc->usage->usage_norm;
+	}
+	list_iterator_destroy(itr);
+
+	parent->usage->children_usage_norm = sum;
+}
+
 /* This should initially get the children list from assoc_mgr_root_assoc.
  * Since our algorithm goes from top down we calculate all the non-user
  * associations now.  When a user submits a job, that norm_fairshare is
@@ -451,6 +485,8 @@ static int _set_children_usage_efctv(List children_list)
 			continue;
 		}
 		priority_p_set_assoc_usage(assoc);
+		if (flags & PRIORITY_FLAGS_DEPTH_OBLIVIOUS)
+			_set_children_usage_norm(assoc);
 		_set_children_usage_efctv(assoc->usage->children_list);
 	}
 	list_iterator_destroy(itr);
@@ -694,6 +730,24 @@ static uint32_t _get_priority_internal(time_t start_time,
 }
 
 
+/* Recalculate a job's priority in the decay thread. Only flag the job
+ * records as changed if the priority did change: most jobs keep the same
+ * priority from one PriorityCalcPeriod to the next, and every job_list
+ * consumer keyed on last_job_update (state save, scheduling, RPC caches)
+ * would otherwise redo its work after each decay pass. */
+static void _set_job_priority(struct job_record *job_ptr, time_t start_time)
+{
+	uint32_t new_prio = _get_priority_internal(start_time, job_ptr);
+
+	if (new_prio == job_ptr->priority)
+		return;
+
+	job_ptr->priority = new_prio;
+	last_job_update = time(NULL);
+	debug2("priority for job %u is now %u",
+	       job_ptr->job_id, job_ptr->priority);
+}
+
 /* Mark an association and its parents as active (i.e. it may be given
  * tickets) during the current scheduling cycle.  The association
  * manager lock should be held on entry.  */
@@ -1111,10 +1165,7 @@ static void _ticket_based_decay(List job_list, time_t start_time)
 		if ((job_ptr->priority == 0) || !IS_JOB_PENDING(job_ptr))
 			continue;
 
-		job_ptr->priority = _get_priority_internal(start_time, job_ptr);
-		last_job_update = time(NULL);
-		debug2("priority for job %u is now %u",
-		       job_ptr->job_id, job_ptr->priority);
+		_set_job_priority(job_ptr, start_time);
 	}
 	list_iterator_destroy(itr);
 	unlock_slurmctld(job_write_lock);
@@ -1477,14 +1528,21 @@ static void _depth_oblivious_set_usage_efctv(
 		ratio_p = (parent_assoc->usage->usage_efctv /
 			   parent_assoc->usage->shares_norm);
 
-		ratio_s = 0;
-		sib_itr = list_iterator_create(
-			parent_assoc->usage->children_list);
-		while ((sibling = list_next(sib_itr))) {
-			if(sibling->shares_raw != SLURMDB_FS_USE_PARENT)
-				ratio_s += sibling->usage->usage_norm;
+		/* Sum set by _set_children_usage_norm() in the decay
+		 * thread, only walk the siblings for associations added
+		 * since then */
+		ratio_s = parent_assoc->usage->children_usage_norm;
+		if (ratio_s < assoc->usage->usage_norm) {
+			ratio_s = 0;
+			sib_itr = list_iterator_create(
+				parent_assoc->usage->children_list);
+			while ((sibling = list_next(sib_itr))) {
+				if (sibling->shares_raw !=
+				    SLURMDB_FS_USE_PARENT)
+					ratio_s += sibling->usage->usage_norm;
+			}
+			list_iterator_destroy(sib_itr);
 		}
-		list_iterator_destroy(sib_itr);
 		ratio_s /= parent_assoc->usage->shares_norm;
 
 		ratio_l = (assoc->usage->usage_norm /
@@ -1917,11 +1975,7 @@ extern void decay_apply_weighted_factors(struct job_record *job_ptr,
 	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
 		return;
 
-	job_ptr->priority = _get_priority_internal(*start_time_ptr, job_ptr);
-	last_job_update = time(NULL);
-	debug2("priority for job %u is now %u",
-	       job_ptr->job_id, job_ptr->priority);
-
+	_set_job_priority(job_ptr, *start_time_ptr);
 }
 
 
@@ -95,6 +95,10 @@
 #define BACKFILL_WINDOW		(24 * 60 * 60)
 #define BF_MAX_USERS		1000
 #define BF_MAX_JOB_ARRAY_RESV	20
+#define BF_FAIL_HASH_SIZE	4096
+#define BF_FAIL_CACHE_AGE	300	/* seconds to trust a failed test */
+#define BF_NODE_SPACE_INIT	16	/* initial node_space records in each
+					 * partition group's table */
 
 #define SLURMCTLD_THREAD_LIMIT	5
 #define SCHED_TIMEOUT		2000000	/* time in micro-seconds */
@@ -107,6 +111,30 @@ typedef struct node_space_map {
 	int next;	/* next record, by time, zero termination */
 } node_space_map_t;
 
+/* Record of a job which could not run in some partition on any of the
+ * available nodes. The will-run test does not remove every running job
+ * (e.g. suspended jobs, jobs without an end time and jobs which can be
+ * preempted with PreemptMode=OFF), so the result depends upon the job's
+ * resource request, the configuration of the nodes tested and the jobs
+ * allocated to them. It need not be re-tested on subsequent backfill
+ * cycles unless one of those changes or more nodes become available.
+ * Node configuration changes are detected through
+ * slurmctld_conf.last_update (reconfiguration) and node_config_update_cnt
+ * (features, gres or weight changed with "scontrol update node"), and job
+ * allocation changes through node_usage_update_cnt. */
+typedef struct bf_fail_rec {
+	uint32_t job_id;
+	struct part_record *part_ptr;
+	uint32_t req_hash;	/* hash of the job's resource request */
+	time_t config_update;	/* slurmctld_conf.last_update when tested */
+	uint32_t node_config_cnt; /* node_config_update_cnt when tested */
+	uint32_t node_usage_cnt; /* node_usage_update_cnt when tested */
+	time_t part_update;	/* last_part_update when tested */
+	time_t test_time;	/* time of the test */
+	bitstr_t *avail_bitmap;	/* nodes the job was tested on */
+	struct bf_fail_rec *next;
+} bf_fail_rec_t;
+
 /* Diag statistics */
 extern diag_stats_t slurmctld_diag_stats;
 int bf_last_yields = 0;
@@ -130,13 +158,23 @@ static bool backfill_continue = false;
 static int defer_rpc_cnt = 0;
 static int sched_timeout = SCHED_TIMEOUT;
 static int yield_sleep   = YIELD_SLEEP;
+static bf_fail_rec_t *bf_fail_hash[BF_FAIL_HASH_SIZE];
 
 /*********************** local functions *********************/
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     bitstr_t *res_bitmap,
-			     node_space_map_t *node_space,
-			     int *node_space_recs);
+			     node_space_map_t **node_space_ptr,
+			     int *node_space_recs, int *node_space_size);
 static int  _attempt_backfill(void);
+static int  _build_part_groups(struct part_record ***part_array,
+			       int **group_array, int *part_cnt);
+static bool _bf_fail_test(struct job_record *job_ptr,
+			  struct part_record *part_ptr, bitstr_t *avail_bitmap,
+			  time_t now);
+static void _bf_fail_purge(time_t now);
+static void _bf_fail_record(struct job_record *job_ptr,
+			    struct part_record *part_ptr,
+			    bitstr_t *resv_bitmap, time_t now);
 static void _clear_job_start_times(void);
 static int  _delta_tv(struct timeval *tv);
 static bool _job_is_completing(void);
@@ -272,6 +310,176 @@ static int _num_feature_count(struct job_record *job_ptr)
 	return rc;
 }
 
+static uint32_t _hash_data(uint32_t hash, const void *data, int len)
+{
+	const unsigned char *ptr = data;
+	int i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= ptr[i];
+		hash *= 16777619;	/* FNV-1a prime */
+	}
+	return hash;
+}
+
+static uint32_t _hash_str(uint32_t hash, const char *str)
+{
+	if (!str)
+		return _hash_data(hash, "", 1);
+	return _hash_data(hash, str, strlen(str) + 1);
+}
+
+/* Return a hash of the fields of a job's resource request which can
+ * determine whether it can run on some set of nodes */
+static uint32_t _job_req_hash(struct job_record *job_ptr)
+{
+	struct job_details *detail_ptr = job_ptr->details;
+	uint32_t hash = 2166136261U;	/* FNV-1a offset basis */
+
+#define HASH_FIELD(field) hash = _hash_data(hash, &(field), sizeof(field))
+	HASH_FIELD(detail_ptr->min_cpus);
+	HASH_FIELD(detail_ptr->max_cpus);
+	HASH_FIELD(detail_ptr->min_nodes);
+	HASH_FIELD(detail_ptr->max_nodes);
+	HASH_FIELD(detail_ptr->num_tasks);
+	HASH_FIELD(detail_ptr->pn_min_cpus);
+	HASH_FIELD(detail_ptr->pn_min_memory);
+	HASH_FIELD(detail_ptr->pn_min_tmp_disk);
+	HASH_FIELD(detail_ptr->cpus_per_task);
+	HASH_FIELD(detail_ptr->ntasks_per_node);
+	HASH_FIELD(detail_ptr->contiguous);
+	HASH_FIELD(detail_ptr->core_spec);
+	HASH_FIELD(detail_ptr->overcommit);
+	HASH_FIELD(detail_ptr->share_res);
+	HASH_FIELD(detail_ptr->whole_node);
+	HASH_FIELD(detail_ptr->task_dist);
+	HASH_FIELD(job_ptr->time_limit);
+	HASH_FIELD(job_ptr->time_min);
+	if (detail_ptr->mc_ptr)
+		HASH_FIELD(*detail_ptr->mc_ptr);
+#undef HASH_FIELD
+	hash = _hash_str(hash, detail_ptr->features);
+	hash = _hash_str(hash, detail_ptr->req_nodes);
+	hash = _hash_str(hash, detail_ptr->exc_nodes);
+	hash = _hash_str(hash, job_ptr->gres);
+	hash = _hash_str(hash, job_ptr->network);
+
+	return hash;
+}
+
+static void _bf_fail_rec_free(bf_fail_rec_t *fail_ptr)
+{
+	FREE_NULL_BITMAP(fail_ptr->avail_bitmap);
+	xfree(fail_ptr);
+}
+
+/* Find the record of a failed test for a job in a given partition */
+static bf_fail_rec_t *_bf_fail_find(uint32_t job_id,
+				    struct part_record *part_ptr)
+{
+	bf_fail_rec_t *fail_ptr;
+
+	fail_ptr = bf_fail_hash[job_id % BF_FAIL_HASH_SIZE];
+	while (fail_ptr) {
+		if ((fail_ptr->job_id == job_id) &&
+		    (fail_ptr->part_ptr == part_ptr))
+			break;
+		fail_ptr = fail_ptr->next;
+	}
+	return fail_ptr;
+}
+
+/* Return true if a previous backfill cycle found that this job can not run
+ * in this partition on a superset of avail_bitmap, and neither the job's
+ * resource request, the node or partition configuration nor the jobs
+ * allocated to nodes have changed */
+static bool _bf_fail_test(struct job_record *job_ptr,
+			  struct part_record *part_ptr, bitstr_t *avail_bitmap,
+			  time_t now)
+{
+	bf_fail_rec_t *fail_ptr = _bf_fail_find(job_ptr->job_id, part_ptr);
+
+	if (!fail_ptr ||
+	    (fail_ptr->config_update != slurmctld_conf.last_update) ||
+	    (fail_ptr->node_config_cnt != node_config_update_cnt) ||
+	    (fail_ptr->node_usage_cnt != node_usage_update_cnt) ||
+	    (fail_ptr->part_update != last_part_update) ||
+	    (difftime(now, fail_ptr->test_time) >= BF_FAIL_CACHE_AGE) ||
+	    (fail_ptr->req_hash != _job_req_hash(job_ptr)))
+		return false;
+	return bit_super_set(avail_bitmap, fail_ptr->avail_bitmap);
+}
+
+/* Record that a job can not run in this partition on any of the nodes
+ * not set in resv_bitmap */
+static void _bf_fail_record(struct job_record *job_ptr,
+			    struct part_record *part_ptr,
+			    bitstr_t *resv_bitmap, time_t now)
+{
+	bf_fail_rec_t *fail_ptr = _bf_fail_find(job_ptr->job_id, part_ptr);
+	int inx;
+
+	if (!fail_ptr) {
+		fail_ptr = xmalloc(sizeof(bf_fail_rec_t));
+		fail_ptr->job_id = job_ptr->job_id;
+		fail_ptr->part_ptr = part_ptr;
+		inx = job_ptr->job_id % BF_FAIL_HASH_SIZE;
+		fail_ptr->next = bf_fail_hash[inx];
+		bf_fail_hash[inx] = fail_ptr;
+	} else {
+		FREE_NULL_BITMAP(fail_ptr->avail_bitmap);
+	}
+	fail_ptr->req_hash = _job_req_hash(job_ptr);
+	fail_ptr->config_update = slurmctld_conf.last_update;
+	fail_ptr->node_config_cnt = node_config_update_cnt;
+	fail_ptr->node_usage_cnt = node_usage_update_cnt;
+	fail_ptr->part_update = last_part_update;
+	fail_ptr->test_time = now;
+	fail_ptr->avail_bitmap = bit_copy(resv_bitmap);
+	bit_not(fail_ptr->avail_bitmap);
+}
+
+/* Remove all failed test records */
+static void _bf_fail_free_all(void)
+{
+	bf_fail_rec_t *fail_ptr;
+	int inx;
+
+	for (inx = 0; inx < BF_FAIL_HASH_SIZE; inx++) {
+		while ((fail_ptr = bf_fail_hash[inx])) {
+			bf_fail_hash[inx] = fail_ptr->next;
+			_bf_fail_rec_free(fail_ptr);
+		}
+	}
+}
+
+/* Remove failed test records which have expired or whose job is no longer
+ * pending */
+static void _bf_fail_purge(time_t now)
+{
+	bf_fail_rec_t *fail_ptr, **prev_ptr;
+	struct job_record *job_ptr;
+	int inx;
+
+	for (inx = 0; inx < BF_FAIL_HASH_SIZE; inx++) {
+		prev_ptr = &bf_fail_hash[inx];
+		while ((fail_ptr = *prev_ptr)) {
+			job_ptr = find_job_record(fail_ptr->job_id);
+			if (!job_ptr || !IS_JOB_PENDING(job_ptr) ||
+			    (fail_ptr->config_update !=
+			     slurmctld_conf.last_update) ||
+			    (fail_ptr->part_update != last_part_update) ||
+			    (difftime(now, fail_ptr->test_time) >=
+			     BF_FAIL_CACHE_AGE)) {
+				*prev_ptr = fail_ptr->next;
+				_bf_fail_rec_free(fail_ptr);
+			} else {
+				prev_ptr = &fail_ptr->next;
+			}
+		}
+	}
+}
+
 /* Attempt to schedule a specific job on specific available nodes
  * IN job_ptr - job to schedule
  * IN/OUT avail_bitmap - nodes available/selected to use
@@ -613,10 +821,13 @@ extern void *backfill_agent(void *args)
 			continue;
 
 		lock_slurmctld(all_locks);
+		bit_cache_begin();
 		(void) _attempt_backfill();
+		bit_cache_end();
 		last_backfill_time = time(NULL);
 		unlock_slurmctld(all_locks);
 	}
+	_bf_fail_free_all();
 	return NULL;
 }
 
@@ -635,6 +846,80 @@ static void _clear_job_start_times(void)
 	list_iterator_destroy(job_iterator);
 }
 
+/* Partitions which share nodes, directly or through other partitions, are
+ * placed in the same group. Reservations made for jobs in one group can never
+ * involve the nodes of another group, so each group is given its own
+ * node_space table. This keeps each table (and the walks over it for every
+ * job tested) limited to the reservations which can actually conflict.
+ * OUT part_array - usable partitions, xfree() by caller
+ * OUT group_array - group index of each partition, xfree() by caller
+ * OUT part_cnt - number of records in part_array and group_array
+ * RET number of groups */
+static int _build_part_groups(struct part_record ***part_array,
+			      int **group_array, int *part_cnt)
+{
+	ListIterator part_iterator;
+	struct part_record *part_ptr, **parts;
+	int *group, *group_map, i, j, k, old_grp, new_grp, cnt = 0;
+	int group_cnt = 0;
+
+	parts = xmalloc(sizeof(struct part_record *) * list_count(part_list));
+	part_iterator = list_iterator_create(part_list);
+	while ((part_ptr = (struct part_record *) list_next(part_iterator))) {
+		if (part_ptr->node_bitmap)
+			parts[cnt++] = part_ptr;
+	}
+	list_iterator_destroy(part_iterator);
+
+	group = xmalloc(sizeof(int) * (cnt + 1));
+	for (i = 0; i < cnt; i++)
+		group[i] = i;
+	for (i = 0; i < cnt; i++) {
+		for (j = i + 1; j < cnt; j++) {
+			if ((group[i] == group[j]) ||
+			    !bit_overlap(parts[i]->node_bitmap,
+					 parts[j]->node_bitmap))
+				continue;
+			old_grp = MAX(group[i], group[j]);
+			new_grp = MIN(group[i], group[j]);
+			for (k = 0; k < cnt; k++) {
+				if (group[k] == old_grp)
+					group[k] = new_grp;
+			}
+		}
+	}
+
+	/* Renumber the groups sequentially from zero */
+	group_map = xmalloc(sizeof(int) * (cnt + 1));
+	for (i = 0; i < cnt; i++)
+		group_map[i] = -1;
+	for (i = 0; i < cnt; i++) {
+		if (group_map[group[i]] == -1)
+			group_map[group[i]] = group_cnt++;
+		group[i] = group_map[group[i]];
+	}
+	xfree(group_map);
+
+	*part_array = parts;
+	*group_array = group;
+	*part_cnt = cnt;
+	return group_cnt;
+}
+
+/* Return the group index of a partition, -1 if not found */
+static int _part_group(struct part_record *part_ptr,
+		       struct part_record **part_array, int *group_array,
+		       int part_cnt)
+{
+	int i;
+
+	for (i = 0; i < part_cnt; i++) {
+		if (part_array[i] == part_ptr)
+			return group_array[i];
+	}
+	return -1;
+}
+
 /* Return non-zero to break the backfill loop if change in job, node or
  * partition state or the backfill scheduler needs to be stopped. */
 static int _yield_locks(int usec)
@@ -668,7 +953,7 @@ static int _attempt_backfill(void)
 	List job_queue;
 	job_queue_rec_t *job_queue_rec;
 	slurmdb_qos_rec_t *qos_ptr = NULL;
-	int i, j, node_space_recs;
+	int i, j, *node_space_recs;
 	struct job_record *job_ptr;
 	struct part_record *part_ptr, **bf_part_ptr = NULL;
 	uint32_t end_time, end_reserve;
@@ -678,7 +963,12 @@ static int _attempt_backfill(void)
 	bitstr_t *exc_core_bitmap = NULL, *non_cg_bitmap = NULL;
 	time_t now, sched_start, later_start, start_res, resv_end, window_end;
 	time_t orig_start_time = (time_t) 0;
-	node_space_map_t *node_space;
+	node_space_map_t *node_space, **grp_node_space = NULL;
+	int *grp_node_space_recs = NULL, *grp_node_space_size = NULL;
+	int grp, grp_cnt, grp_full_cnt = 0;
+	struct part_record **grp_part_ptr = NULL;
+	int *grp_part_inx = NULL, grp_parts = 0;
+	bool *grp_full = NULL;
 	struct timeval bf_time1, bf_time2;
 	int rc = 0;
 	int job_test_count = 0;
@@ -739,6 +1029,7 @@ static int _attempt_backfill(void)
 
 	if (backfill_continue)
 		_clear_job_start_times();
+	_bf_fail_purge(now);
 
 	gettimeofday(&bf_time1, NULL);
 
@@ -753,16 +1044,34 @@ static int _attempt_backfill(void)
 	slurmctld_diag_stats.bf_when_last_cycle = now;
 	slurmctld_diag_stats.bf_active = 1;
 
-	node_space = xmalloc(sizeof(node_space_map_t) *
-			     (max_backfill_job_cnt * 2 + 1));
-	node_space[0].begin_time = sched_start;
 	window_end = sched_start + backfill_window;
-	node_space[0].end_time = window_end;
-	node_space[0].avail_bitmap = bit_copy(avail_node_bitmap);
-	node_space[0].next = 0;
-	node_space_recs = 1;
-	if (debug_flags & DEBUG_FLAG_BACKFILL_MAP)
-		_dump_node_space_table(node_space);
+	grp_cnt = _build_part_groups(&grp_part_ptr, &grp_part_inx, &grp_parts);
+	grp_node_space = xmalloc(sizeof(node_space_map_t *) * (grp_cnt + 1));
+	grp_node_space_recs = xmalloc(sizeof(int) * (grp_cnt + 1));
+	grp_node_space_size = xmalloc(sizeof(int) * (grp_cnt + 1));
+	grp_full = xmalloc(sizeof(bool) * (grp_cnt + 1));
+	for (grp = 0; grp < grp_cnt; grp++) {
+		/* Most groups hold few reservations, the table is grown by
+		 * _add_reservation() as needed */
+		grp_node_space_size[grp] = MIN(BF_NODE_SPACE_INIT,
+					       max_backfill_job_cnt * 2 + 1);
+		node_space = xmalloc(sizeof(node_space_map_t) *
+				     grp_node_space_size[grp]);
+		node_space[0].begin_time = sched_start;
+		node_space[0].end_time = window_end;
+		node_space[0].avail_bitmap = bit_copy(avail_node_bitmap);
+		node_space[0].next = 0;
+		grp_node_space[grp] = node_space;
+		grp_node_space_recs[grp] = 1;
+	}
+	if ((debug_flags & DEBUG_FLAG_BACKFILL) && (grp_cnt > 1))
+		info("backfill: %d independent partition groups", grp_cnt);
+	if (debug_flags & DEBUG_FLAG_BACKFILL_MAP) {
+		for (grp = 0; grp < grp_cnt; grp++) {
+			info("backfill: partition group %d", grp);
+			_dump_node_space_table(grp_node_space[grp]);
+		}
+	}
 
 	if (max_backfill_job_per_part) {
 		ListIterator part_iterator;
@@ -938,12 +1247,18 @@ next_task:
 
 		if (((part_ptr->state_up & PARTITION_SCHED) == 0) ||
 		    (part_ptr->node_bitmap == NULL) ||
-		    ((part_ptr->flags & PART_FLAG_ROOT_ONLY) && filter_root)) {
+		    ((part_ptr->flags & PART_FLAG_ROOT_ONLY) && filter_root) ||
+		    ((grp = _part_group(part_ptr, grp_part_ptr, grp_part_inx,
+					grp_parts)) < 0)) {
 			if (debug_flags & DEBUG_FLAG_BACKFILL)
 				info("backfill: partition %s not usable",
 				     job_ptr->part_ptr->name);
 			continue;
 		}
+		if (grp_full[grp])
+			continue;	/* No space for more reservations */
+		node_space = grp_node_space[grp];
+		node_space_recs = &grp_node_space_recs[grp];
 
 		if ((!job_independent(job_ptr, 0)) ||
 		    (license_job_test(job_ptr, time(NULL)) != SLURM_SUCCESS)) {
@@ -1091,10 +1406,8 @@ next_task:
 		}
 
 		if (job_ptr->details->exc_node_bitmap) {
-			bit_not(job_ptr->details->exc_node_bitmap);
-			bit_and(avail_bitmap,
+			bit_and_not(avail_bitmap,
 				job_ptr->details->exc_node_bitmap);
-			bit_not(job_ptr->details->exc_node_bitmap);
 		}
 
 		/* Test if insufficient nodes remain OR
@@ -1123,6 +1436,22 @@ next_task:
 			continue;
 		}
 
+		/* Test if the job was previously found unable to run on
+		 * these nodes (no need to call _try_sched again) */
+		if (!exc_core_bitmap &&
+		    _bf_fail_test(job_ptr, part_ptr, avail_bitmap, now)) {
+			if (debug_flags & DEBUG_FLAG_BACKFILL)
+				info("backfill: job %u previously found not "
+				     "runable in partition %s",
+				     job_ptr->job_id, part_ptr->name);
+			job_ptr->time_limit = orig_time_limit;
+			if (orig_start_time != 0)  /* Can start in other part */
+				job_ptr->start_time = orig_start_time;
+			else
+				job_ptr->start_time = 0;
+			continue;
+		}
+
 		/* Identify nodes which are definitely off limits */
 		FREE_NULL_BITMAP(resv_bitmap);
 		resv_bitmap = bit_copy(avail_bitmap);
@@ -1144,6 +1473,10 @@ next_task:
 
 		now = time(NULL);
 		if (j != SLURM_SUCCESS) {
+			if (!exc_core_bitmap) {
+				_bf_fail_record(job_ptr, part_ptr, resv_bitmap,
+						now);
+			}
 			job_ptr->time_limit = orig_time_limit;
 			if (orig_start_time != 0)  /* Can start in other part */
 				job_ptr->start_time = orig_start_time;
@@ -1276,12 +1609,16 @@ next_task:
 			continue;
 		}
 
-		if (node_space_recs >= max_backfill_job_cnt) {
+		if (*node_space_recs >= max_backfill_job_cnt) {
 			if (debug_flags & DEBUG_FLAG_BACKFILL) {
-				info("backfill: table size limit of %u reached",
-				     max_backfill_job_cnt);
+				info("backfill: table size limit of %u reached "
+				     "for partition %s",
+				     max_backfill_job_cnt, part_ptr->name);
 			}
-			break;
+			grp_full[grp] = true;
+			if (++grp_full_cnt >= grp_cnt)
+				break;
+			continue;
 		}
 
 		if ((job_ptr->start_time > now) &&
@@ -1307,8 +1644,10 @@ next_task:
 		xfree(job_ptr->sched_nodes);
 		job_ptr->sched_nodes = bitmap2node_name(avail_bitmap);
 		bit_not(avail_bitmap);
-		_add_reservation(start_time, end_reserve,
-				 avail_bitmap, node_space, &node_space_recs);
+		_add_reservation(start_time, end_reserve, avail_bitmap,
+				 &grp_node_space[grp], node_space_recs,
+				 &grp_node_space_size[grp]);
+		node_space = grp_node_space[grp];
 		if (debug_flags & DEBUG_FLAG_BACKFILL_MAP)
 			_dump_node_space_table(node_space);
 		if ((orig_start_time != 0) &&
@@ -1338,12 +1677,21 @@ next_task:
 	FREE_NULL_BITMAP(resv_bitmap);
 	FREE_NULL_BITMAP(non_cg_bitmap);
 
-	for (i=0; ; ) {
-		FREE_NULL_BITMAP(node_space[i].avail_bitmap);
-		if ((i = node_space[i].next) == 0)
-			break;
+	for (grp = 0; grp < grp_cnt; grp++) {
+		node_space = grp_node_space[grp];
+		for (i=0; ; ) {
+			FREE_NULL_BITMAP(node_space[i].avail_bitmap);
+			if ((i = node_space[i].next) == 0)
+				break;
+		}
+		xfree(node_space);
 	}
-	xfree(node_space);
+	xfree(grp_node_space);
+	xfree(grp_node_space_recs);
+	xfree(grp_node_space_size);
+	xfree(grp_full);
+	xfree(grp_part_ptr);
+	xfree(grp_part_inx);
 	list_destroy(job_queue);
 	gettimeofday(&bf_time2, NULL);
 	_do_diag_stats(&bf_time1, &bf_time2, yield_sleep);
@@ -1429,8 +1777,9 @@ static void _reset_job_time_limit(struct job_record *job_ptr, time_t now,
 	uint32_t new_time_limit;
 
 	for (j=0; ; ) {
+		if (node_space[j].begin_time >= job_ptr->end_time)
+			break;	/* Table is ordered by time */
 		if ((node_space[j].begin_time != now) &&
-		    (node_space[j].begin_time < job_ptr->end_time) &&
 		    (!bit_super_set(job_ptr->node_bitmap,
 				    node_space[j].avail_bitmap))) {
 			/* Job overlaps pending job's resource reservation */
@@ -1470,95 +1819,93 @@ static bool _more_work (time_t last_backfill_time)
 	return rc;
 }
 
-/* Create a reservation for a job in the future */
+/* Split node_space record j at time split_time, the new record covers the
+ * later portion of the original time span.
+ * RET index of the new record */
+static int _split_node_space(node_space_map_t *node_space,
+			     int *node_space_recs, int j, time_t split_time)
+{
+	int i = *node_space_recs;
+
+	node_space[i].begin_time = split_time;
+	node_space[i].end_time = node_space[j].end_time;
+	node_space[j].end_time = split_time;
+	node_space[i].avail_bitmap = bit_copy(node_space[j].avail_bitmap);
+	node_space[i].next = node_space[j].next;
+	node_space[j].next = i;
+	(*node_space_recs)++;
+
+	return i;
+}
+
+/* Create a reservation for a job in the future
+ * IN/OUT node_space_ptr - table of node_space records, grown as needed
+ * IN/OUT node_space_recs - number of records used in the table
+ * IN/OUT node_space_size - number of records allocated to the table */
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     bitstr_t *res_bitmap,
-			     node_space_map_t *node_space,
-			     int *node_space_recs)
+			     node_space_map_t **node_space_ptr,
+			     int *node_space_recs, int *node_space_size)
 {
-	bool placed = false;
-	int i, j;
-
-#if 0	
-	info("add job start:%u end:%u", start_time, end_reserve);
-	for (j = 0; ; ) {
-		info("node start:%u end:%u",
-		     (uint32_t) node_space[j].begin_time,
-		     (uint32_t) node_space[j].end_time);
-		if ((j = node_space[j].next) == 0)
-			break;
+	node_space_map_t *node_space;
+	int i, j, prev = -1;
+
+	/* Up to two records are added by splitting existing records */
+	if ((*node_space_recs + 2) > *node_space_size) {
+		*node_space_size = MAX(*node_space_size * 2,
+				       *node_space_recs + 2);
+		xrealloc(*node_space_ptr,
+			 sizeof(node_space_map_t) * *node_space_size);
 	}
-#endif
+	node_space = *node_space_ptr;
 
 	start_time = MAX(start_time, node_space[0].begin_time);
-	for (j = 0; ; ) {
-		if (node_space[j].end_time > start_time) {
-			/* insert start entry record */
-			i = *node_space_recs;
-			node_space[i].begin_time = start_time;
-			node_space[i].end_time = node_space[j].end_time;
-			node_space[j].end_time = start_time;
-			node_space[i].avail_bitmap =
-				bit_copy(node_space[j].avail_bitmap);
-			node_space[i].next = node_space[j].next;
-			node_space[j].next = i;
-			(*node_space_recs)++;
-			placed = true;
-		}
-		if (node_space[j].end_time == start_time) {
-			/* no need to insert new start entry record */
-			placed = true;
-		}
-		if (placed == true) {
-			while ((j = node_space[j].next)) {
-				if (end_reserve < node_space[j].end_time) {
-					/* insert end entry record */
-					i = *node_space_recs;
-					node_space[i].begin_time = end_reserve;
-					node_space[i].end_time = node_space[j].
-								 end_time;
-					node_space[j].end_time = end_reserve;
-					node_space[i].avail_bitmap =
-						bit_copy(node_space[j].
-							 avail_bitmap);
-					node_space[i].next = node_space[j].next;
-					node_space[j].next = i;
-					(*node_space_recs)++;
-					break;
-				}
-				if (end_reserve == node_space[j].end_time) {
-					break;
-				}
-			}
-			break;
-		}
+	if (end_reserve <= start_time)
+		return;
+
+	/* Locate the record containing start_time, splitting it as needed */
+	for (j = 0; node_space[j].end_time <= start_time; ) {
+		prev = j;
 		if ((j = node_space[j].next) == 0)
-			break;
+			return;		/* Starts beyond the backfill window */
 	}
-
-	for (j = 0; ; ) {
-		if ((node_space[j].begin_time >= start_time) &&
-		    (node_space[j].end_time <= end_reserve))
-			bit_and(node_space[j].avail_bitmap, res_bitmap);
-		if ((node_space[j].begin_time >= end_reserve) ||
-		    ((j = node_space[j].next) == 0))
+	if (node_space[j].begin_time < start_time) {
+		prev = j;
+		j = _split_node_space(node_space, node_space_recs, j,
+				      start_time);
+	}
+	if (prev == -1)
+		prev = j;
+
+	/* Remove reserved nodes from every record within the reservation's
+	 * time span, splitting the last record at end_reserve as needed */
+	while (node_space[j].begin_time < end_reserve) {
+		if (node_space[j].end_time > end_reserve) {
+			(void) _split_node_space(node_space, node_space_recs,
+						 j, end_reserve);
+		}
+		bit_and(node_space[j].avail_bitmap, res_bitmap);
+		if ((j = node_space[j].next) == 0)
 			break;
 	}
 
-	/* Drop records with identical bitmaps (up to one record).
-	 * This can significantly improve performance of the backfill tests. */
-	for (i = 0; ; ) {
+	/* Merge adjacent records with identical bitmaps. Only records at or
+	 * adjacent to the reservation's time span can have changed, so there
+	 * is no need to examine the remainder of the table. This can
+	 * significantly improve performance of the backfill tests. */
+	for (i = prev; ; ) {
 		if ((j = node_space[i].next) == 0)
 			break;
 		if (!bit_equal(node_space[i].avail_bitmap,
 			       node_space[j].avail_bitmap)) {
+			if (node_space[j].begin_time >= end_reserve)
+				break;
 			i = j;
 			continue;
 		}
 		node_space[i].end_time = node_space[j].end_time;
 		node_space[i].next = node_space[j].next;
 		FREE_NULL_BITMAP(node_space[j].avail_bitmap);
-		break;
 	}
 }
 
@@ -1578,8 +1925,9 @@ static bool _test_resv_overlap(node_space_map_t *node_space,
 	int j;
 
 	for (j=0; ; ) {
-		if ((node_space[j].end_time   > start_time) &&
-		    (node_space[j].begin_time < end_reserve) &&
+		if (node_space[j].begin_time >= end_reserve)
+			break;	/* Table is ordered by time */
+		if ((node_space[j].end_time > start_time) &&
 		    (!bit_super_set(use_bitmap, node_space[j].avail_bitmap))) {
 			overlap = true;
 			break;
@@ -2061,6 +2061,7 @@ extern int select_p_job_test(struct job_record *job_ptr, bitstr_t * bitmap,
 		job_ptr->details->mc_ptr = _create_default_mc();
 	job_node_req = _get_job_node_req(job_ptr);
 
+	bit_cache_begin();
 	if (select_debug_flags & DEBUG_FLAG_SELECT_TYPE) {
 		info("cons_res: select_p_job_test: job %u node_req %u mode %d",
 		     job_ptr->job_id, job_node_req, mode);
@@ -2084,6 +2085,7 @@ extern int select_p_job_test(struct job_record *job_ptr, bitstr_t * bitmap,
 			      exc_core_bitmap);
 	} else
 		fatal("select_p_job_test: Mode %d is invalid", mode);
+	bit_cache_end();
 
 	if (select_debug_flags & DEBUG_FLAG_SELECT_TYPE) {
 		if (job_ptr->job_resrcs)
@@ -75,6 +75,7 @@
 #include <signal.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -86,6 +87,7 @@
 #include "src/common/macros.h"
 #include "src/common/node_select.h"
 #include "src/common/parse_time.h"
+#include "src/common/slurm_auth.h"
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_interface.h"
 #include "src/common/uid.h"
@@ -144,6 +146,8 @@ typedef struct agent_info {
 	slurm_msg_type_t msg_type;	/* RPC to be issued */
 	void **msg_args_pptr;		/* RPC data to be used */
 	uint16_t protocol_version;	/* if set, use this version */
+	void *auth_cred;		/* credential shared by all threads */
+	time_t auth_cred_time;		/* when auth_cred was created */
 } agent_info_t;
 
 typedef struct task_info {
@@ -157,6 +161,7 @@ typedef struct task_info {
 	slurm_msg_type_t msg_type;	/* RPC to be issued */
 	void *msg_args_ptr;		/* ptr to RPC data to be used */
 	uint16_t protocol_version;	/* if set, use this version */
+	void *auth_cred;		/* shared credential, NULL to make one */
 } task_info_t;
 
 typedef struct queued_request {
@@ -187,7 +192,9 @@ static int _setup_requeue(agent_arg_t *agent_arg_ptr, thd_t *thread_ptr,
 static void _spawn_retry_agent(agent_arg_t * agent_arg_ptr);
 static void *_thread_per_group_rpc(void *args);
 static int   _valid_agent_arg(agent_arg_t *agent_arg_ptr);
+static bool _srun_agent(slurm_msg_type_t msg_type);
 static void *_wdog(void *args);
+static int _wdog_wait(agent_info_t *agent_ptr, unsigned long usec);
 
 static mail_info_t *_mail_alloc(void);
 static void  _mail_free(void *arg);
@@ -268,6 +275,18 @@ void *agent(void *args)
 	agent_info_ptr = _make_agent_info(agent_arg_ptr);
 	thread_ptr = agent_info_ptr->thread_struct;
 
+	/* Every thread sends to a different set of nodes, so they can all
+	 * use the same credential rather than each asking munged for one.
+	 * The forward tree only uses it for the first attempt to each
+	 * subtree, since a retry may reach nodes that have already seen it.
+	 * srun messages may go to several sruns behind one munged. */
+	if ((agent_info_ptr->thread_count > 1) &&
+	    !_srun_agent(agent_info_ptr->msg_type)) {
+		agent_info_ptr->auth_cred = g_slurm_auth_create(
+			NULL, 2, slurm_get_auth_info());
+		agent_info_ptr->auth_cred_time = time(NULL);
+	}
+
 	/* start the watchdog thread */
 	if (getenv("SLURM_NO_WDOG")) {
 		/* Test purposes only. Do not want threads to be interrupted
@@ -356,6 +375,8 @@ void *agent(void *args)
 	_purge_agent_args(agent_arg_ptr);
 
 	if (agent_info_ptr) {
+		if (agent_info_ptr->auth_cred)
+			(void) g_slurm_auth_destroy(agent_info_ptr->auth_cred);
 		xfree(agent_info_ptr->thread_struct);
 		xfree(agent_info_ptr);
 	}
@@ -502,6 +523,10 @@ static task_info_t *_make_task_data(agent_info_t *agent_info_ptr, int inx)
 	task_info_ptr->msg_type          = agent_info_ptr->msg_type;
 	task_info_ptr->msg_args_ptr      = *agent_info_ptr->msg_args_pptr;
 	task_info_ptr->protocol_version  = agent_info_ptr->protocol_version;
+	/* Same freshness limit slurm_send_node_msg() uses for its own */
+	if (agent_info_ptr->auth_cred &&
+	    (difftime(time(NULL), agent_info_ptr->auth_cred_time) < 60))
+		task_info_ptr->auth_cred = agent_info_ptr->auth_cred;
 
 	return task_info_ptr;
 }
@@ -539,11 +564,50 @@ static void _update_wdog_state(thd_t *thread_ptr,
 	}
 }
 
+/* Return true if msg_type is sent by the agent to srun rather than slurmd */
+static bool _srun_agent(slurm_msg_type_t msg_type)
+{
+	if ( (msg_type == SRUN_JOB_COMPLETE)			||
+	     (msg_type == SRUN_REQUEST_SUSPEND)			||
+	     (msg_type == SRUN_STEP_MISSING)			||
+	     (msg_type == SRUN_STEP_SIGNAL)			||
+	     (msg_type == SRUN_EXEC)				||
+	     (msg_type == SRUN_NODE_FAIL)			||
+	     (msg_type == SRUN_PING)				||
+	     (msg_type == SRUN_TIMEOUT)				||
+	     (msg_type == SRUN_USER_MSG)			||
+	     (msg_type == RESPONSE_RESOURCE_ALLOCATION) )
+		return true;
+	return false;
+}
+
+/*
+ * _wdog_wait - Wait up to usec microseconds for one of the agent's threads
+ *	to complete. Caller must hold agent_ptr->thread_mutex.
+ * RET ETIMEDOUT if no thread completed in that time, 0 otherwise
+ */
+static int _wdog_wait(agent_info_t *agent_ptr, unsigned long usec)
+{
+	struct timeval now;
+	struct timespec abs_time;
+	unsigned long nsec;
+
+	gettimeofday(&now, NULL);
+	nsec = (now.tv_usec + usec) * 1000;
+	abs_time.tv_sec  = now.tv_sec + (nsec / 1000000000);
+	abs_time.tv_nsec = nsec % 1000000000;
+
+	return pthread_cond_timedwait(&agent_ptr->thread_cond,
+				      &agent_ptr->thread_mutex, &abs_time);
+}
+
 /*
  * _wdog - Watchdog thread. Send SIGUSR1 to threads which have been active
  *	for too long.
  * IN args - pointer to agent_info_t with info on threads to watch
- * Sleep between polls with exponential times (from 0.125 to 1.0 second)
+ * Poll with exponential times (from 0.005 to 1.0 second), but wake up
+ * whenever a thread completes so the agent finishes as soon as the last
+ * RPC does rather than at the next poll.
  */
 static void *_wdog(void *args)
 {
@@ -556,17 +620,7 @@ static void *_wdog(void *args)
 	thd_complete_t thd_comp;
 	ret_data_info_t *ret_data_info = NULL;
 
-	if ( (agent_ptr->msg_type == SRUN_JOB_COMPLETE)			||
-	     (agent_ptr->msg_type == SRUN_REQUEST_SUSPEND)		||
-	     (agent_ptr->msg_type == SRUN_STEP_MISSING)			||
-	     (agent_ptr->msg_type == SRUN_STEP_SIGNAL)			||
-	     (agent_ptr->msg_type == SRUN_EXEC)				||
-	     (agent_ptr->msg_type == SRUN_NODE_FAIL)			||
-	     (agent_ptr->msg_type == SRUN_PING)				||
-	     (agent_ptr->msg_type == SRUN_TIMEOUT)			||
-	     (agent_ptr->msg_type == SRUN_USER_MSG)			||
-	     (agent_ptr->msg_type == RESPONSE_RESOURCE_ALLOCATION) )
-		srun_agent = true;
+	srun_agent = _srun_agent(agent_ptr->msg_type);
 
 	thd_comp.max_delay = 0;
 
@@ -575,12 +629,12 @@ static void *_wdog(void *args)
 		thd_comp.fail_cnt    = 0;   /* assume no threads failures */
 		thd_comp.no_resp_cnt = 0;   /* assume all threads respond */
 		thd_comp.retry_cnt   = 0;   /* assume no required retries */
-		thd_comp.now         = time(NULL);
-
-		usleep(usec);
-		usec = MIN((usec * 2), 1000000);
 
 		slurm_mutex_lock(&agent_ptr->thread_mutex);
+		if (_wdog_wait(agent_ptr, usec) == ETIMEDOUT)
+			usec = MIN((usec * 2), 1000000);
+		thd_comp.now         = time(NULL);
+
 		for (i = 0; i < agent_ptr->thread_count; i++) {
 			//info("thread name %s",thread_ptr[i].node_name);
 			if (!thread_ptr[i].ret_list) {
@@ -867,6 +921,7 @@ static void *_thread_per_group_rpc(void *args)
 
 	msg.msg_type = msg_type;
 	msg.data     = task_ptr->msg_args_ptr;
+	msg.send_auth_cred = task_ptr->auth_cred;
 #if 0
  	info("sending message type %u to %s", msg_type, thread_ptr->nodelist);
 #endif
@@ -1055,9 +1110,10 @@ cleanup:
 	thread_ptr->state = thread_state;
 	thread_ptr->end_time = (time_t) difftime(time(NULL),
 						 thread_ptr->start_time);
-	/* Signal completion so another thread can replace us */
+	/* Signal completion so another thread can replace us, the
+	 * watchdog waits on the same condition */
 	(*threads_active_ptr)--;
-	pthread_cond_signal(thread_cond_ptr);
+	pthread_cond_broadcast(thread_cond_ptr);
 	slurm_mutex_unlock(thread_mutex_ptr);
 	return (void *) NULL;
 }
@@ -46,6 +46,7 @@
 #endif				/* WITH_PTHREADS */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -62,6 +63,7 @@
 #include "src/common/slurm_auth.h"
 #include "src/common/slurm_accounting_storage.h"
 #include "src/common/switch.h"
+#include "src/common/timers.h"
 #include "src/common/xsignal.h"
 #include "src/common/xstring.h"
 
@@ -79,12 +81,15 @@
 #endif
 
 #define SHUTDOWN_WAIT     2	/* Time to wait for primary server shutdown */
+#define PREFETCH_BUF_SIZE (1024 * 1024)	/* read size for state prefetch */
 
 static int          _background_process_msg(slurm_msg_t * msg);
 static void *       _background_rpc_mgr(void *no_data);
 static void *       _background_signal_hand(void *no_data);
 static void         _backup_reconfig(void);
 static int          _ping_controller(void);
+static void         _prefetch_state_files(void);
+static void *       _prefetch_state_thread(void *no_data);
 static int          _shutdown_primary_controller(int wait_time);
 static void	     _trigger_slurmctld_event(uint32_t trig_type);
 inline static void  _update_cred_key(void);
@@ -93,6 +98,16 @@ inline static void  _update_cred_key(void);
 static bool          dump_core = false;
 static VOLATILE bool takeover = false;
 static time_t last_controller_response;
+static pthread_mutex_t prefetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool prefetch_active = false;
+
+/* State files read on takeover by read_slurm_conf() and
+ * ctld_assoc_mgr_init(), relative to StateSaveLocation */
+static char *prefetch_files[] = {
+	"assoc_mgr_state", "assoc_usage", "front_end_state", "job_state",
+	"node_state", "part_state", "qos_usage", "resv_state",
+	"trigger_state", NULL
+};
 
 /*
  * Static list of signals to block in this process
@@ -111,6 +126,7 @@ void run_backup(slurm_trigger_callbacks_t *callbacks)
 	int i;
 	uint32_t trigger_type;
 	time_t last_ping = 0;
+	bool prefetched = false;
 	pthread_attr_t thread_attr_sig, thread_attr_rpc;
 	slurmctld_lock_t config_read_lock = {
 		READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
@@ -166,9 +182,10 @@ void run_backup(slurm_trigger_callbacks_t *callbacks)
 			continue;
 
 		last_ping = time(NULL);
-		if (_ping_controller() == 0)
+		if (_ping_controller() == 0) {
 			last_controller_response = time(NULL);
-		else if (takeover) {
+			prefetched = false;
+		} else if (takeover) {
 			/* in takeover mode, take control as soon as */
 			/* primary no longer respond */
 			break;
@@ -182,6 +199,13 @@ void run_backup(slurm_trigger_callbacks_t *callbacks)
 			    timeout) {
 				break;
 			}
+
+			/* Likely to take over once SlurmctldTimeout expires,
+			 * the state files can be read ahead of time */
+			if (!prefetched) {
+				_prefetch_state_files();
+				prefetched = true;
+			}
 		}
 	}
 
@@ -466,6 +490,72 @@ static int _ping_controller(void)
 	return SLURM_PROTOCOL_SUCCESS;
 }
 
+/*
+ * Read the state files once the primary controller stops responding, while
+ * waiting for SlurmctldTimeout to expire. Their contents are discarded, but
+ * are then cached by the operating system so that recovering state on
+ * takeover does not wait on the (typically shared) file system. A primary
+ * which is not responding should not be writing new state files either.
+ */
+static void _prefetch_state_files(void)
+{
+	pthread_attr_t attr;
+	pthread_t thread_id;
+
+	slurm_mutex_lock(&prefetch_mutex);
+	if (prefetch_active) {
+		slurm_mutex_unlock(&prefetch_mutex);
+		return;
+	}
+	prefetch_active = true;
+	slurm_mutex_unlock(&prefetch_mutex);
+
+	slurm_attr_init(&attr);
+	if (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED))
+		error("pthread_attr_setdetachstate error %m");
+	if (pthread_create(&thread_id, &attr, _prefetch_state_thread, NULL)) {
+		error("pthread_create error %m");
+		slurm_mutex_lock(&prefetch_mutex);
+		prefetch_active = false;
+		slurm_mutex_unlock(&prefetch_mutex);
+	}
+	slurm_attr_destroy(&attr);
+}
+
+static void *_prefetch_state_thread(void *no_data)
+{
+	char *data, *file_name, *state_dir;
+	int fd, i;
+	ssize_t data_read;
+	DEF_TIMERS;
+
+	START_TIMER;
+	state_dir = slurm_get_state_save_location();
+	data = xmalloc(PREFETCH_BUF_SIZE);
+	for (i = 0; prefetch_files[i]; i++) {
+		file_name = xstrdup_printf("%s/%s", state_dir,
+					   prefetch_files[i]);
+		fd = open(file_name, O_RDONLY);
+		if (fd >= 0) {
+			do {
+				data_read = read(fd, data, PREFETCH_BUF_SIZE);
+			} while ((data_read > 0) ||
+				 ((data_read < 0) && (errno == EINTR)));
+			close(fd);
+		}
+		xfree(file_name);
+	}
+	xfree(data);
+	xfree(state_dir);
+	END_TIMER;
+	debug("Prefetched state files from primary controller %s", TIME_STR);
+
+	slurm_mutex_lock(&prefetch_mutex);
+	prefetch_active = false;
+	slurm_mutex_unlock(&prefetch_mutex);
+	return NULL;
+}
+
 /*
  * Reload the slurm.conf parameters without any processing
  * of the node, partition, or state information.
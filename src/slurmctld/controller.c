@@ -651,6 +651,7 @@ int main(int argc, char *argv[])
 	xfree(dir_name);
 	reserve_port_config(NULL);
 	free_rpc_stats();
+	pack_cache_fini();
 
 	/* Some plugins are needed to purge job/node data structures,
 	 * unplug after other data structures are purged */
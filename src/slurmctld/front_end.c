@@ -784,7 +784,7 @@ extern int load_all_front_end_state(bool state_only)
 {
 #ifdef HAVE_FRONT_END
 	char *node_name = NULL, *reason = NULL, *data = NULL, *state_file;
-	int data_allocated, data_read = 0, error_code = 0, node_cnt = 0;
+	int error_code = 0, node_cnt = 0;
 	uint32_t node_state;
 	uint32_t data_size = 0, name_len;
 	uint32_t reason_uid = NO_VAL;
@@ -803,24 +803,7 @@ extern int load_all_front_end_state(bool state_only)
 		info ("No node state file (%s) to recover", state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size], BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error ("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		data = read_state_file(state_fd, state_file, 0, &data_size);
 		close (state_fd);
 	}
 	xfree (state_file);
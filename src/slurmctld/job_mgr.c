@@ -120,6 +120,19 @@ typedef struct {
 	bitstr_t **resp_array_task_id;
 } resp_array_struct_t;
 
+/* Packed state save record of a finished job and the fields it was packed
+ * with, see _dump_job_state_cached() */
+typedef struct job_state_cache {
+	Buf buffer;
+	uint32_t db_index;
+	uint32_t derived_ec;
+	time_t end_time;
+	uint32_t exit_code;
+	uint16_t job_state;
+	uint32_t priority;
+	uint16_t restart_cnt;
+} job_state_cache_t;
+
 /* Global variables */
 List   job_list = NULL;		/* job_record list */
 time_t last_job_update;		/* time of last update to job records */
@@ -149,27 +162,28 @@ static void _add_job_hash(struct job_record *job_ptr);
 static void _add_job_array_hash(struct job_record *job_ptr);
 static int  _checkpoint_job_record (struct job_record *job_ptr,
 				    char *image_dir);
-static int  _copy_job_desc_files(uint32_t job_id_src, uint32_t job_id_dest);
 static int  _copy_job_desc_to_file(job_desc_msg_t * job_desc,
 				   uint32_t job_id);
 static int  _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 					 struct job_record **job_ptr,
 					 bitstr_t ** exc_bitmap,
 					 bitstr_t ** req_bitmap);
-static int _copy_job_file(const char *src, const char *dst);
 static job_desc_msg_t * _copy_job_record_to_job_desc(
 				struct job_record *job_ptr);
 static char *_copy_nodelist_no_dup(char *node_list);
 static struct job_record *_create_job_record(int *error_code,
 					     uint32_t num_jobs);
 static void _del_batch_list_rec(void *x);
+static bool _array_tasks_remain(struct job_record *job_ptr);
 static void _delete_job_desc_files(uint32_t job_id);
+static void _delete_job_files(struct job_record *job_ptr);
 static slurmdb_qos_rec_t *_determine_and_validate_qos(
 	char *resv_name, slurmdb_association_rec_t *assoc_ptr,
 	bool admin, slurmdb_qos_rec_t *qos_rec,	int *error_code);
 static void _dump_job_details(struct job_details *detail_ptr,
 			      Buf buffer);
 static void _dump_job_state(struct job_record *dump_job_ptr, Buf buffer);
+static void _dump_job_state_cached(struct job_record *job_ptr, Buf buffer);
 static int  _find_batch_dir(void *x, void *key);
 static void _get_batch_job_dir_ids(List batch_dirs);
 static time_t _get_last_state_write_time(void);
@@ -178,6 +192,7 @@ static void _job_timed_out(struct job_record *job_ptr);
 static int  _job_create(job_desc_msg_t * job_specs, int allocate, int will_run,
 			struct job_record **job_rec_ptr, uid_t submit_uid,
 			char **err_msg);
+static void _job_state_cache_free(struct job_record *job_ptr);
 static void _list_delete_job(void *job_entry);
 static int  _list_find_job_id(void *job_entry, void *key);
 static int  _list_find_job_old(void *job_entry, void *key);
@@ -203,6 +218,10 @@ static int  _read_data_array_from_file(char *file_name, char ***data,
 				       uint32_t * size,
 				       struct job_record *job_ptr);
 static int  _read_data_from_file(char *file_name, char **data);
+static int  _read_job_env(uint32_t job_id, char ***env, uint32_t *env_size,
+			  struct job_record *job_ptr);
+static int  _read_job_script(uint32_t job_id, char **script);
+static uint32_t _job_file_id(struct job_record *job_ptr);
 static char *_read_job_ckpt_file(char *ckpt_file, int *size_ptr);
 static void _remove_defunct_batch_dirs(List batch_dirs);
 static void _remove_job_hash(struct job_record *job_ptr);
@@ -479,7 +498,7 @@ void delete_job_details(struct job_record *job_entry)
 
 	xassert (job_entry->details->magic == DETAILS_MAGIC);
 	if (IS_JOB_FINISHED(job_entry))
-		_delete_job_desc_files(job_entry->job_id);
+		_delete_job_files(job_entry);
 
 	xfree(job_entry->details->acctg_freq);
 	for (i=0; i<job_entry->details->argc; i++)
@@ -548,6 +567,50 @@ static void _delete_job_desc_files(uint32_t job_id)
 	xfree(dir_name);
 }
 
+/* Return true if any record of job_ptr's job array, other than job_ptr
+ * itself, still exists. The pending meta record is not in
+ * job_array_hash_j, so check for it separately. */
+static bool _array_tasks_remain(struct job_record *job_ptr)
+{
+	struct job_record *task_ptr;
+	int inx;
+
+	task_ptr = find_job_record(job_ptr->array_job_id);
+	if (task_ptr && (task_ptr != job_ptr) && task_ptr->array_recs &&
+	    task_ptr->array_recs->task_cnt)
+		return true;
+
+	inx = JOB_HASH_INX(job_ptr->array_job_id);
+	task_ptr = job_array_hash_j[inx];
+	while (task_ptr) {
+		if ((task_ptr != job_ptr) &&
+		    (task_ptr->array_job_id == job_ptr->array_job_id))
+			return true;
+		task_ptr = task_ptr->job_array_next_j;
+	}
+	return false;
+}
+
+/* Delete the script and environment files of a finished job. The files of
+ * a job array are shared by all of its tasks, so they are only deleted
+ * along with the last task record. Records of pending tasks may already be
+ * gone when all job records are freed at shutdown, so leave the files for
+ * _remove_defunct_batch_dirs() to purge upon restart in that case. */
+static void _delete_job_files(struct job_record *job_ptr)
+{
+	uint32_t file_id = _job_file_id(job_ptr);
+
+	if (file_id != job_ptr->job_id) {
+		/* Files copied for this task by an earlier version */
+		_delete_job_desc_files(job_ptr->job_id);
+	}
+	if ((job_ptr->array_task_id == NO_VAL) && !job_ptr->array_recs)
+		_delete_job_desc_files(file_id);
+	else if (!slurmctld_config.shutdown_time &&
+		 !_array_tasks_remain(job_ptr))
+		_delete_job_desc_files(file_id);
+}
+
 static uint32_t _max_switch_wait(uint32_t input_wait)
 {
 	static time_t sched_update = 0;
@@ -708,7 +771,7 @@ int dump_all_job_state(void)
 		    (! IS_JOB_COMPLETING(job_ptr)) && IS_JOB_FINISHED(job_ptr))
 			continue;	/* job ready for purging, don't dump */
 
-		_dump_job_state(job_ptr, buffer);
+		_dump_job_state_cached(job_ptr, buffer);
 	}
 	list_iterator_destroy(job_iterator);
 
@@ -893,7 +956,7 @@ unpack_error:
  */
 extern int load_all_job_state(void)
 {
-	int data_allocated, data_read = 0, error_code = SLURM_SUCCESS;
+	int error_code = SLURM_SUCCESS;
 	uint32_t data_size = 0;
 	int state_fd, job_cnt = 0;
 	char *data = NULL, *state_file;
@@ -903,33 +966,17 @@ extern int load_all_job_state(void)
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
 	uint16_t protocol_version = (uint16_t)NO_VAL;
+	DEF_TIMERS;
 
 	/* read the file */
+	START_TIMER;
 	lock_state_files();
 	state_fd = _open_job_state_file(&state_file);
 	if (state_fd < 0) {
 		info("No job state file (%s) to recover", state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		data = read_state_file(state_fd, state_file, 0, &data_size);
 		close(state_fd);
 	}
 	xfree(state_file);
@@ -973,12 +1020,14 @@ extern int load_all_job_state(void)
 	debug3("Set job_id_sequence to %u", job_id_sequence);
 
 	free_buf(buffer);
-	info("Recovered information about %d jobs", job_cnt);
+	END_TIMER2("load_all_job_state");
+	info("Recovered information about %d jobs %s", job_cnt, TIME_STR);
 	return error_code;
 
 unpack_error:
 	error("Incomplete job data checkpoint file");
-	info("Recovered information about %d jobs", job_cnt);
+	END_TIMER2("load_all_job_state");
+	info("Recovered information about %d jobs %s", job_cnt, TIME_STR);
 	free_buf(buffer);
 	return SLURM_FAILURE;
 }
@@ -990,7 +1039,7 @@ unpack_error:
  */
 extern int load_last_job_id( void )
 {
-	int data_allocated, data_read = 0, error_code = SLURM_SUCCESS;
+	int error_code = SLURM_SUCCESS;
 	uint32_t data_size = 0;
 	int state_fd;
 	char *data = NULL, *state_file;
@@ -1009,25 +1058,9 @@ extern int load_last_job_id( void )
 		debug("No job state file (%s) to recover", state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		/* Only the header is needed, not the job records */
+		data = read_state_file(state_fd, state_file, BUF_SIZE,
+				       &data_size);
 		close(state_fd);
 	}
 	xfree(state_file);
@@ -1070,6 +1103,74 @@ unpack_error:
 	return SLURM_FAILURE;
 }
 
+/*
+ * _dump_job_state_cached - dump the state of a specific job as with
+ *	_dump_job_state(). The packed record of a finished job is kept with
+ *	the job and copied into later state saves for as long as the fields
+ *	which can still change after job termination are unchanged, so only
+ *	active jobs need to be packed again on each save.
+ * IN job_ptr - pointer to job for which information is requested
+ * IN/OUT buffer - location to store data, pointers automatically advanced
+ */
+static void _dump_job_state_cached(struct job_record *job_ptr, Buf buffer)
+{
+	job_state_cache_t *cache = job_ptr->state_cache;
+	uint32_t offset, size;
+
+	if (!IS_JOB_FINISHED(job_ptr) || IS_JOB_COMPLETING(job_ptr) ||
+	    job_ptr->array_recs) {
+		if (cache)
+			_job_state_cache_free(job_ptr);
+		_dump_job_state(job_ptr, buffer);
+		return;
+	}
+
+	if (cache &&
+	    (cache->job_state   == job_ptr->job_state)   &&
+	    (cache->end_time    == job_ptr->end_time)    &&
+	    (cache->db_index    == job_ptr->db_index)    &&
+	    (cache->derived_ec  == job_ptr->derived_ec)  &&
+	    (cache->exit_code   == job_ptr->exit_code)   &&
+	    (cache->priority    == job_ptr->priority)    &&
+	    (cache->restart_cnt == job_ptr->restart_cnt)) {
+		packmem_array(get_buf_data(cache->buffer),
+			      get_buf_offset(cache->buffer), buffer);
+		return;
+	}
+
+	offset = get_buf_offset(buffer);
+	_dump_job_state(job_ptr, buffer);
+	size = get_buf_offset(buffer) - offset;
+
+	if (cache) {
+		set_buf_offset(cache->buffer, 0);
+	} else {
+		cache = xmalloc(sizeof(job_state_cache_t));
+		cache->buffer = init_buf(size);
+		job_ptr->state_cache = cache;
+	}
+	packmem_array(get_buf_data(buffer) + offset, size, cache->buffer);
+	cache->job_state   = job_ptr->job_state;
+	cache->end_time    = job_ptr->end_time;
+	cache->db_index    = job_ptr->db_index;
+	cache->derived_ec  = job_ptr->derived_ec;
+	cache->exit_code   = job_ptr->exit_code;
+	cache->priority    = job_ptr->priority;
+	cache->restart_cnt = job_ptr->restart_cnt;
+}
+
+/* Discard a job's cached state save record, see _dump_job_state_cached() */
+static void _job_state_cache_free(struct job_record *job_ptr)
+{
+	job_state_cache_t *cache = job_ptr->state_cache;
+
+	if (!cache)
+		return;
+	free_buf(cache->buffer);
+	xfree(cache);
+	job_ptr->state_cache = NULL;
+}
+
 /*
  * _dump_job_state - dump the state of a specific job, its details, and
  *	steps to a buffer
@@ -2537,6 +2638,58 @@ extern bool test_job_array_pending(uint32_t array_job_id)
 	return false;
 }
 
+/*
+ * Determine the state of all tasks of a job array with a single scan of its
+ *	records. Equivalent to test_job_array_complete(),
+ *	test_job_array_completed() and test_job_array_pending().
+ * IN array_job_id - job array's job ID
+ * OUT complete - set if ALL tasks are complete
+ * OUT completed - set if ALL tasks are completed
+ * OUT pending - set if ANY tasks are pending
+ */
+extern void test_job_array_state(uint32_t array_job_id, bool *complete,
+				 bool *completed, bool *pending)
+{
+	struct job_record *job_ptr;
+	int inx;
+
+	*complete = true;
+	*completed = true;
+	*pending = false;
+
+	job_ptr = find_job_record(array_job_id);
+	if (job_ptr) {
+		if (!IS_JOB_COMPLETE(job_ptr))
+			*complete = false;
+		if (!IS_JOB_COMPLETED(job_ptr))
+			*completed = false;
+		if (IS_JOB_PENDING(job_ptr))
+			*pending = true;
+		if (job_ptr->array_recs && job_ptr->array_recs->task_cnt) {
+			*complete = false;
+			*completed = false;
+			*pending = true;
+		}
+		if (job_ptr->array_recs && job_ptr->array_recs->max_exit_code)
+			*complete = false;
+	}
+
+	/* Need to test individual job array records */
+	inx = JOB_HASH_INX(array_job_id);
+	job_ptr = job_array_hash_j[inx];
+	while (job_ptr && (*complete || *completed || !*pending)) {
+		if (job_ptr->array_job_id == array_job_id) {
+			if (!IS_JOB_COMPLETE(job_ptr))
+				*complete = false;
+			if (!IS_JOB_COMPLETED(job_ptr))
+				*completed = false;
+			if (IS_JOB_PENDING(job_ptr))
+				*pending = true;
+		}
+		job_ptr = job_ptr->job_array_next_j;
+	}
+}
+
 /*
  * find_job_array_rec - return a pointer to the job record with the given
  *	array_job_id/array_task_id
@@ -3456,11 +3609,8 @@ struct job_record *_job_rec_copy(struct job_record *job_ptr)
 		fatal("%s: job %u record lacks array structure",
 		      __func__, job_ptr->job_id);
 	}
-	if (_copy_job_desc_files(job_ptr_pend->job_id, job_ptr->job_id)) {
-		/* Need to quit here to preserve job record integrity */
-		fatal("%s: failed to copy enviroment/script files for job %u",
-		      __func__, job_ptr->job_id);
-	}
+	/* The new task record shares the script and environment files of
+	 * the job array, see _job_file_id() */
 
 	/* Copy most of original job data.
 	 * This could be done in parallel, but performance was worse. */
@@ -5816,91 +5966,6 @@ static bool _dup_job_file_test(uint32_t job_id)
 	return false;
 }
 
-/* _copy_job_desc_files - create copies of a job script and environment files */
-static int
-_copy_job_desc_files(uint32_t job_id_src, uint32_t job_id_dest)
-{
-	int error_code = SLURM_SUCCESS, hash;
-	char *dir_name_src, *dir_name_dest, job_dir[40];
-	char *file_name_src, *file_name_dest;
-
-	/* Create state_save_location directory */
-	dir_name_src  = slurm_get_state_save_location();
-	dir_name_dest = xstrdup(dir_name_src);
-
-	/* Create directory based upon job ID due to limitations on the number
-	 * of files possible in a directory on some file system types (e.g.
-	 * up to 64k files on a FAT32 file system). */
-	hash = job_id_dest % 10;
-	sprintf(job_dir, "/hash.%d", hash);
-	xstrcat(dir_name_dest, job_dir);
-	(void) mkdir(dir_name_dest, 0700);
-
-	/* Create job_id_dest specific directory */
-	sprintf(job_dir, "/job.%u", job_id_dest);
-	xstrcat(dir_name_dest, job_dir);
-	if (mkdir(dir_name_dest, 0700)) {
-		if (!slurmctld_primary && (errno == EEXIST)) {
-			error("Apparent duplicate job ID %u. Two primary "
-			      "slurmctld daemons might currently be active",
-			      job_id_dest);
-		}
-		error("mkdir(%s) error %m", dir_name_dest);
-		xfree(dir_name_src);
-		xfree(dir_name_dest);
-		return ESLURM_WRITING_TO_FILE;
-	}
-
-	/* Identify job_id_src specific directory */
-	hash = job_id_src % 10;
-	sprintf(job_dir, "/hash.%d", hash);
-	xstrcat(dir_name_src, job_dir);
-	(void) mkdir(dir_name_src, 0700);
-	sprintf(job_dir, "/job.%u", job_id_src);
-	xstrcat(dir_name_src, job_dir);
-
-	file_name_src  = xstrdup(dir_name_src);
-	file_name_dest = xstrdup(dir_name_dest);
-	xstrcat(file_name_src,  "/environment");
-	xstrcat(file_name_dest, "/environment");
-	error_code = link(file_name_src, file_name_dest);
-	if (error_code < 0) {
-		error("%s: link() failed %m copy files src %s dest %s",
-		      __func__, file_name_src, file_name_dest);
-		error_code = _copy_job_file(file_name_src, file_name_dest);
-		if (error_code < 0) {
-			error("%s: failed copy files %m src %s dst %s",
-			      __func__, file_name_src, file_name_dest);
-		}
-	}
-	xfree(file_name_src);
-	xfree(file_name_dest);
-
-	if (error_code == 0) {
-		file_name_src  = xstrdup(dir_name_src);
-		file_name_dest = xstrdup(dir_name_dest);
-		xstrcat(file_name_src,  "/script");
-		xstrcat(file_name_dest, "/script");
-		error_code = link(file_name_src, file_name_dest);
-		if (error_code < 0) {
-			error("%s: link() failed %m copy files src %s dest %s",
-			      __func__, file_name_src, file_name_dest);
-			error_code = _copy_job_file(file_name_src,
-						    file_name_dest);
-			if (error_code < 0) {
-				error("%s: failed copy files %m src %s dst %s",
-				      __func__, file_name_src, file_name_dest);
-			}
-		}
-		xfree(file_name_src);
-		xfree(file_name_dest);
-	}
-
-	xfree(dir_name_src);
-	xfree(dir_name_dest);
-	return error_code;
-}
-
 /*
  * Create file with specified name and write the supplied data array to it
  * IN file_name - file to create and write to
@@ -5995,25 +6060,16 @@ static int _write_data_to_file(char *file_name, char *data)
  */
 char **get_job_env(struct job_record *job_ptr, uint32_t * env_size)
 {
-	char job_dir[30], *file_name, **environment = NULL;
-	int hash = job_ptr->job_id % 10;
+	char **environment = NULL;
+	uint32_t file_id = _job_file_id(job_ptr);
 
-	file_name = slurm_get_state_save_location();
-	sprintf(job_dir, "/hash.%d/job.%u/environment", hash, job_ptr->job_id);
-	xstrcat(file_name, job_dir);
-
-	if (_read_data_array_from_file(file_name, &environment, env_size,
-				       job_ptr)) {
-		/* Read state from version 14.03 or earlier */
-		xfree(file_name);
-		file_name = slurm_get_state_save_location();
-		sprintf(job_dir, "/job.%u/environment", job_ptr->job_id);
-		xstrcat(file_name, job_dir);
-		(void) _read_data_array_from_file(file_name, &environment,
-						  env_size, job_ptr);
+	if (_read_job_env(file_id, &environment, env_size, job_ptr) &&
+	    (file_id != job_ptr->job_id)) {
+		/* Job array task files copied by an earlier version */
+		(void) _read_job_env(job_ptr->job_id, &environment, env_size,
+				     job_ptr);
 	}
 
-	xfree(file_name);
 	return environment;
 }
 
@@ -6024,28 +6080,82 @@ char **get_job_env(struct job_record *job_ptr, uint32_t * env_size)
  */
 char *get_job_script(struct job_record *job_ptr)
 {
-	char *file_name, job_dir[40], *script = NULL;
-	int hash;
+	char *script = NULL;
+	uint32_t file_id;
 
 	if (!job_ptr->batch_flag)
 		return NULL;
 
-	hash = job_ptr->job_id % 10;
+	file_id = _job_file_id(job_ptr);
+	if (_read_job_script(file_id, &script) &&
+	    (file_id != job_ptr->job_id)) {
+		/* Job array task files copied by an earlier version */
+		(void) _read_job_script(job_ptr->job_id, &script);
+	}
+
+	return script;
+}
+
+/*
+ * Return the job ID whose state save directory holds a job's script and
+ * environment files. All tasks of a job array share the files written for
+ * the array when it was submitted rather than each having its own copy.
+ */
+static uint32_t _job_file_id(struct job_record *job_ptr)
+{
+	if ((job_ptr->array_task_id != NO_VAL) && job_ptr->array_job_id)
+		return job_ptr->array_job_id;
+	return job_ptr->job_id;
+}
+
+/* Read the environment file of job_id, RET 0 on success */
+static int _read_job_env(uint32_t job_id, char ***env, uint32_t *env_size,
+			 struct job_record *job_ptr)
+{
+	char job_dir[40], *file_name;
+	int hash = job_id % 10, rc;
+
+	file_name = slurm_get_state_save_location();
+	sprintf(job_dir, "/hash.%d/job.%u/environment", hash, job_id);
+	xstrcat(file_name, job_dir);
+
+	rc = _read_data_array_from_file(file_name, env, env_size, job_ptr);
+	if (rc) {
+		/* Read state from version 14.03 or earlier */
+		xfree(file_name);
+		file_name = slurm_get_state_save_location();
+		sprintf(job_dir, "/job.%u/environment", job_id);
+		xstrcat(file_name, job_dir);
+		rc = _read_data_array_from_file(file_name, env, env_size,
+						job_ptr);
+	}
+
+	xfree(file_name);
+	return rc;
+}
+
+/* Read the script file of job_id, RET 0 on success */
+static int _read_job_script(uint32_t job_id, char **script)
+{
+	char job_dir[40], *file_name;
+	int hash = job_id % 10, rc;
+
 	file_name = slurm_get_state_save_location();
-	sprintf(job_dir, "/hash.%d/job.%u/script", hash, job_ptr->job_id);
+	sprintf(job_dir, "/hash.%d/job.%u/script", hash, job_id);
 	xstrcat(file_name, job_dir);
 
-	if (_read_data_from_file(file_name, &script)) {
+	rc = _read_data_from_file(file_name, script);
+	if (rc) {
 		/* Read version 14.03 or earlier state format */
 		xfree(file_name);
 		file_name = slurm_get_state_save_location();
-		sprintf(job_dir, "/job.%u/script", job_ptr->job_id);
+		sprintf(job_dir, "/job.%u/script", job_id);
 		xstrcat(file_name, job_dir);
-		(void) _read_data_from_file(file_name, &script);
+		rc = _read_data_from_file(file_name, script);
 	}
 
 	xfree(file_name);
-	return script;
+	return rc;
 }
 
 /*
@@ -7063,6 +7173,7 @@ static void _list_delete_job(void *job_entry)
 	for (i = 0; i < job_ptr->spank_job_env_size; i++)
 		xfree(job_ptr->spank_job_env[i]);
 	xfree(job_ptr->spank_job_env);
+	_job_state_cache_free(job_ptr);
 	xfree(job_ptr->state_desc);
 	step_list_purge(job_ptr);
 	select_g_select_jobinfo_free(job_ptr->select_jobinfo);
@@ -8552,6 +8663,9 @@ static int _update_job(struct job_record *job_ptr, job_desc_msg_t * job_specs,
 		return ESLURM_USER_ID_MISSING;
 	}
 
+	/* Fields of a finished job (e.g. comment) may change below */
+	_job_state_cache_free(job_ptr);
+
 	if (!wiki_sched_test) {
 		char *sched_type = slurm_get_sched_type();
 		if (strcmp(sched_type, "sched/wiki") == 0)
@@ -10361,10 +10475,8 @@ extern int update_job_str(slurm_msg_t *msg, uid_t uid)
 			/* Update the record with all pending tasks */
 			rc2 = _update_job(job_ptr, job_specs, uid);
 			_resp_array_add(&resp_array, job_ptr, rc2);
-			bit_not(job_ptr->array_recs->task_id_bitmap);
-			bit_and(array_bitmap,
+			bit_and_not(array_bitmap,
 				job_ptr->array_recs->task_id_bitmap);
-			bit_not(job_ptr->array_recs->task_id_bitmap);
 		} else {
 			/* Need to split out tasks to separate job records */
 			tmp_bitmap = bit_copy(job_ptr->array_recs->
@@ -11047,16 +11159,23 @@ static void _validate_job_files(List batch_dirs)
 {
 	ListIterator job_iterator;
 	struct job_record *job_ptr;
-	int del_cnt;
+	uint32_t file_id;
+	bool found;
 
+	/* Tasks of a job array share one batch_dir, so test for all of the
+	 * files before removing any of them from the list */
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
-		if (!job_ptr->batch_flag)
+		if (!job_ptr->batch_flag || !IS_JOB_PENDING(job_ptr))
 			continue;
-		/* Want to keep this job's files */
-		del_cnt = list_delete_all(batch_dirs, _find_batch_dir,
-					  &(job_ptr->job_id));
-		if ((del_cnt == 0) && IS_JOB_PENDING(job_ptr)) {
+		file_id = _job_file_id(job_ptr);
+		found = list_find_first(batch_dirs, _find_batch_dir,
+					&file_id);
+		if (!found && (file_id != job_ptr->job_id)) {
+			found = list_find_first(batch_dirs, _find_batch_dir,
+						&(job_ptr->job_id));
+		}
+		if (!found) {
 			error("Script for job %u lost, state set to FAILED",
 			      job_ptr->job_id);
 			job_ptr->job_state = JOB_FAILED;
@@ -11067,6 +11186,18 @@ static void _validate_job_files(List batch_dirs)
 			job_completion_logger(job_ptr, false);
 		}
 	}
+	list_iterator_reset(job_iterator);
+	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		if (!job_ptr->batch_flag)
+			continue;
+		/* Want to keep this job's files */
+		file_id = _job_file_id(job_ptr);
+		(void) list_delete_all(batch_dirs, _find_batch_dir, &file_id);
+		if (file_id != job_ptr->job_id) {
+			(void) list_delete_all(batch_dirs, _find_batch_dir,
+					       &(job_ptr->job_id));
+		}
+	}
 	list_iterator_destroy(job_iterator);
 }
 
@@ -11829,6 +11960,7 @@ static int _suspend_job_nodes(struct job_record *job_ptr, bool indf_susp)
 			node_ptr->last_idle  = now;
 		}
 	}
+	node_usage_update_cnt++;
 	last_job_update = last_node_update = now;
 	return rc;
 }
@@ -11877,6 +12009,7 @@ static int _resume_job_nodes(struct job_record *job_ptr, bool indf_susp)
 		node_flags = node_ptr->node_state & NODE_STATE_FLAGS;
 		node_ptr->node_state = NODE_STATE_ALLOCATED | node_flags;
 	}
+	node_usage_update_cnt++;
 	last_job_update = last_node_update = time(NULL);
 	return rc;
 }
@@ -13798,55 +13931,3 @@ extern void job_array_post_sched(struct job_record *job_ptr)
 		}
 	}
 }
-
-/* _copy_job_file()
- *
- * This function is invoked in case the controller fails
- * to link the job array job files. If the link fails the
- * controller tries to copy the files instead.
- *
- */
-static int
-_copy_job_file(const char *src, const char *dst)
-{
-	struct stat stat_buf;
-	int fsrc;
-	int fdst;
-	int cc;
-	char buf[BUFSIZ];
-
-	if (stat(src, &stat_buf) < 0)
-		return -1;
-
-	fsrc = open(src, O_RDONLY);
-	if (fsrc < 0)
-		return -1;
-
-
-	fdst = creat(dst, stat_buf.st_mode);
-	if (fdst < 0) {
-		close(fsrc);
-		return -1;
-	}
-
-	while (1) {
-		cc = read(fsrc, buf, BUFSIZ);
-		if (cc == 0)
-			break;
-		if (cc < 0) {
-			close(fsrc);
-			close(fdst);
-			return -1;
-		}
-		if (write(fdst, buf, cc) != cc) {
-			close(fsrc);
-			close(fdst);
-			return -1;
-		}
-	}
-
-	close(fsrc);
-	close(fdst);
-
-	return 0;
-}
@@ -98,11 +98,28 @@ typedef struct epilog_arg {
 	char **my_env;
 } epilog_arg_t;
 
+#define ARRAY_STATE_CACHE_SIZE	64
+
+typedef struct array_state_cache {
+	uint32_t array_job_id;
+	time_t test_time;
+	time_t job_update;
+	bool complete;
+	bool completed;
+	bool pending;
+} array_state_cache_t;
+
 static char **	_build_env(struct job_record *job_ptr);
 static void	_depend_list_del(void *dep_ptr);
 static void	_feature_list_delete(void *x);
 static void	_job_queue_append(List job_queue, struct job_record *job_ptr,
 				  struct part_record *part_ptr, uint32_t priority);
+static job_queue_rec_t *_job_queue_heap_pop(job_queue_rec_t **heap,
+					     int *rec_cnt, bool sorted);
+static job_queue_rec_t **_job_queue_heapify(List job_queue, int *rec_cnt,
+					     bool *sorted);
+static int	_job_queue_rec_cmp(job_queue_rec_t *job_rec1,
+				   job_queue_rec_t *job_rec2);
 static void	_job_queue_rec_del(void *x);
 static bool	_job_runnable_test1(struct job_record *job_ptr,
 				    bool clear_start);
@@ -118,37 +135,75 @@ static void *	_wait_boot(void *arg);
 #endif
 static int	build_queue_timeout = BUILD_TIMEOUT;
 static int	save_last_part_update = 0;
+static array_state_cache_t array_state_cache[ARRAY_STATE_CACHE_SIZE];
 
 extern diag_stats_t slurmctld_diag_stats;
 
 /*
- * _build_user_job_list - build list of jobs for a given user
- *			  and an optional job name
- * IN  user_id - user id
- * IN  job_name - job name constraint
- * RET the job queue
- * NOTE: the caller must call list_destroy() on RET value to free memory
+ * _singleton_blocked - determine if a job with a singleton dependency must
+ *	wait for another job of the same user and name
+ * IN  job_ptr - job with the singleton dependency
+ * RET true if some job with the same user and name is running, suspended,
+ *	or pending with a lower job ID
  */
-static List _build_user_job_list(uint32_t user_id, char* job_name)
+static bool _singleton_blocked(struct job_record *job_ptr)
 {
-	List job_queue;
 	ListIterator job_iterator;
-	struct job_record *job_ptr = NULL;
+	struct job_record *qjob_ptr;
+	bool blocked = false;
 
-	job_queue = list_create(NULL);
 	job_iterator = list_iterator_create(job_list);
-	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
-		xassert (job_ptr->magic == JOB_MAGIC);
-		if (job_ptr->user_id != user_id)
+	while ((qjob_ptr = (struct job_record *) list_next(job_iterator))) {
+		xassert (qjob_ptr->magic == JOB_MAGIC);
+		if (qjob_ptr->user_id != job_ptr->user_id)
 			continue;
-		if (job_name && job_ptr->name &&
-		    strcmp(job_name, job_ptr->name))
+		if (qjob_ptr->name &&
+		    strcmp(job_ptr->name, qjob_ptr->name))
 			continue;
-		list_append(job_queue, job_ptr);
+		/* already running/suspended job or previously
+		 * submitted pending job */
+		if (IS_JOB_RUNNING(qjob_ptr) ||
+		    IS_JOB_SUSPENDED(qjob_ptr) ||
+		    (IS_JOB_PENDING(qjob_ptr) &&
+		     (qjob_ptr->job_id < job_ptr->job_id))) {
+			blocked = true;
+			break;
+		}
 	}
 	list_iterator_destroy(job_iterator);
 
-	return job_queue;
+	return blocked;
+}
+
+/*
+ * _get_array_state - determine the state of all tasks of a job array.
+ *	Results are cached until a job changes state, so jobs dependent upon
+ *	the same job array need not each scan all of its tasks.
+ * IN  array_job_id - job array's job ID
+ * IN  now - current time
+ * OUT complete - set if ALL tasks are complete
+ * OUT completed - set if ALL tasks are completed
+ * OUT pending - set if ANY tasks are pending
+ */
+static void _get_array_state(uint32_t array_job_id, time_t now,
+			     bool *complete, bool *completed, bool *pending)
+{
+	array_state_cache_t *cache_ptr;
+
+	cache_ptr = &array_state_cache[array_job_id % ARRAY_STATE_CACHE_SIZE];
+	if ((cache_ptr->array_job_id != array_job_id) ||
+	    (cache_ptr->test_time != now) ||
+	    (cache_ptr->job_update != last_job_update)) {
+		test_job_array_state(array_job_id, &cache_ptr->complete,
+				     &cache_ptr->completed,
+				     &cache_ptr->pending);
+		cache_ptr->array_job_id = array_job_id;
+		cache_ptr->test_time = now;
+		cache_ptr->job_update = last_job_update;
+	}
+	*complete  = cache_ptr->complete;
+	*completed = cache_ptr->completed;
+	*pending   = cache_ptr->pending;
 }
 
 static void _job_queue_append(List job_queue, struct job_record *job_ptr,
@@ -161,6 +216,9 @@ static void _job_queue_append(List job_queue, struct job_record *job_ptr,
 	job_queue_rec->job_ptr  = job_ptr;
 	job_queue_rec->part_ptr = part_ptr;
 	job_queue_rec->priority = prio;
+	if (part_ptr)
+		job_queue_rec->part_prio = part_ptr->priority;
+	job_queue_rec->has_resv = (job_ptr->resv_id != 0);
 	list_append(job_queue, job_queue_rec);
 }
 
@@ -169,6 +227,97 @@ static void _job_queue_rec_del(void *x)
 	xfree(x);
 }
 
+/* Restore heap order below heap[inx], see _job_queue_heapify() */
+static void _job_queue_sift_down(job_queue_rec_t **heap, int rec_cnt,
+				 int inx)
+{
+	job_queue_rec_t *tmp_rec;
+	int child;
+
+	while ((child = (inx * 2) + 1) < rec_cnt) {
+		if (((child + 1) < rec_cnt) &&
+		    (_job_queue_rec_cmp(heap[child + 1], heap[child]) < 0))
+			child++;
+		if (_job_queue_rec_cmp(heap[inx], heap[child]) < 0)
+			break;
+		tmp_rec = heap[inx];
+		heap[inx] = heap[child];
+		heap[child] = tmp_rec;
+		inx = child;
+	}
+}
+
+/*
+ * Move the records of a job queue built by build_job_queue() into a binary
+ *	heap ordered by _job_queue_rec_cmp(). The main scheduler typically
+ *	tests only the highest priority jobs, so removing records in order with
+ *	_job_queue_heap_pop() avoids sorting the entire queue. The heap only
+ *	compares the sort keys copied into each record when the queue was
+ *	built, so changes to a job while it still has records in the heap do
+ *	not break the heap order.
+ *	If preemption is enabled the order also depends upon the preemption
+ *	plugin, which tests live job state. In that case the queue is sorted
+ *	once with sort_job_queue2() before any job is changed and the records
+ *	are stored in ascending order, so _job_queue_heap_pop() makes no
+ *	further comparisons.
+ * IN job_queue - job queue, destroyed by this function
+ * OUT rec_cnt - number of records in the heap
+ * OUT sorted - set if the records were sorted rather than heap ordered
+ * RET heap of records, release with _job_queue_heap_pop() and xfree()
+ */
+static job_queue_rec_t **_job_queue_heapify(List job_queue, int *rec_cnt,
+					    bool *sorted)
+{
+	job_queue_rec_t **heap, *job_queue_rec;
+	int i;
+
+	*sorted = slurm_preemption_enabled();
+	if (*sorted)
+		sort_job_queue(job_queue);
+
+	i = list_count(job_queue);
+	*rec_cnt = i;
+	heap = xmalloc(sizeof(job_queue_rec_t *) * (i + 1));
+	if (*sorted) {
+		while ((job_queue_rec = (job_queue_rec_t *)
+					list_pop(job_queue)))
+			heap[--i] = job_queue_rec;
+	} else {
+		i = 0;
+		while ((job_queue_rec = (job_queue_rec_t *)
+					list_pop(job_queue)))
+			heap[i++] = job_queue_rec;
+	}
+	list_destroy(job_queue);
+
+	if (!*sorted) {
+		for (i = (*rec_cnt / 2) - 1; i >= 0; i--)
+			_job_queue_sift_down(heap, *rec_cnt, i);
+	}
+
+	return heap;
+}
+
+/* Remove and return the highest priority record from a job queue heap,
+ * NULL if empty. The caller must xfree() the record. */
+static job_queue_rec_t *_job_queue_heap_pop(job_queue_rec_t **heap,
+					    int *rec_cnt, bool sorted)
+{
+	job_queue_rec_t *job_queue_rec;
+
+	if (*rec_cnt == 0)
+		return NULL;
+
+	if (sorted)
+		return heap[--(*rec_cnt)];
+
+	job_queue_rec = heap[0];
+	heap[0] = heap[--(*rec_cnt)];
+	_job_queue_sift_down(heap, *rec_cnt, 0);
+
+	return job_queue_rec;
+}
+
 /* Job test for ability to run now, excludes partition specific tests */
 static bool _job_runnable_test1(struct job_record *job_ptr, bool clear_start)
 {
@@ -758,13 +907,17 @@ static bool _all_partition_priorities_same(void)
  * RET count of jobs scheduled
  * Note: We re-build the queue every time. Jobs can not only be added
  *	or removed from the queue, but have their priority or partition
- *	changed with the update_job RPC. In general nodes will be in priority
- *	order (by submit time), so the sorting should be pretty fast.
+ *	changed with the update_job RPC. The queue is ordered as a heap
+ *	rather than fully sorted since only the first job_limit jobs
+ *	are normally tested.
  */
 extern int schedule(uint32_t job_limit)
 {
 	ListIterator job_iterator = NULL, part_iterator = NULL;
 	List job_queue = NULL;
+	job_queue_rec_t **job_heap = NULL;
+	int job_heap_cnt = 0;
+	bool job_heap_sorted = false;
 	int failed_part_cnt = 0, failed_resv_cnt = 0, job_cnt = 0;
 	int error_code, i, j, part_cnt, time_limit;
 	uint32_t job_depth = 0;
@@ -808,6 +961,7 @@ extern int schedule(uint32_t job_limit)
 	if (slurmctld_config.shutdown_time)
 		return 0;
 
+	bit_cache_begin();
 #if HAVE_SYS_PRCTL_H
 	if (prctl(PR_GET_NAME, get_name, NULL, NULL, NULL) < 0) {
 		error("%s: cannot get my name %m", __func__);
@@ -1016,7 +1170,9 @@ extern int schedule(uint32_t job_limit)
 	} else {
 		job_queue = build_job_queue(false, false);
 		slurmctld_diag_stats.schedule_queue_len = list_count(job_queue);
-		sort_job_queue(job_queue);
+		job_heap = _job_queue_heapify(job_queue, &job_heap_cnt,
+					      &job_heap_sorted);
+		job_queue = NULL;
 	}
 	while (1) {
 		if (fifo_sched) {
@@ -1054,7 +1210,9 @@ next_part:			part_ptr = (struct part_record *)
 					continue;
 			}
 		} else {
-			job_queue_rec = list_pop(job_queue);
+			job_queue_rec = _job_queue_heap_pop(job_heap,
+							    &job_heap_cnt,
+							    job_heap_sorted);
 			if (!job_queue_rec)
 				break;
 			job_ptr  = job_queue_rec->job_ptr;
@@ -1452,8 +1610,10 @@ next_task:
 			list_iterator_destroy(job_iterator);
 		if (part_iterator)
 			list_iterator_destroy(part_iterator);
-	} else if (job_queue) {
-		FREE_NULL_LIST(job_queue);
+	} else if (job_heap) {
+		for (i = 0; i < job_heap_cnt; i++)
+			xfree(job_heap[i]);
+		xfree(job_heap);
 	}
 	xfree(sched_part_ptr);
 	xfree(sched_part_jobs);
@@ -1469,6 +1629,7 @@ out:
 		      __func__, get_name);
 	}
 #endif
+	bit_cache_end();
 	return job_cnt;
 }
 
@@ -1487,10 +1648,8 @@ extern int sort_job_queue2(void *x, void *y)
 {
 	job_queue_rec_t *job_rec1 = *(job_queue_rec_t **) x;
 	job_queue_rec_t *job_rec2 = *(job_queue_rec_t **) y;
-	bool has_resv1, has_resv2;
 	static time_t config_update = 0;
 	static bool preemption_enabled = true;
-	uint32_t p1, p2;
 
 	/* The following block of code is designed to minimize run time in
 	 * typical configurations for this frequently executed function. */
@@ -1505,39 +1664,30 @@ extern int sort_job_queue2(void *x, void *y)
 			return 1;
 	}
 
-	has_resv1 = (job_rec1->job_ptr->resv_id != 0);
-	has_resv2 = (job_rec2->job_ptr->resv_id != 0);
-	if (has_resv1 && !has_resv2)
+	return _job_queue_rec_cmp(job_rec1, job_rec2);
+}
+
+/* Compare job queue records using only the sort keys copied into them by
+ *	build_job_queue(): reservation, partition priority, job priority in
+ *	that partition, then job id */
+static int _job_queue_rec_cmp(job_queue_rec_t *job_rec1,
+			      job_queue_rec_t *job_rec2)
+{
+	if (job_rec1->has_resv && !job_rec2->has_resv)
 		return -1;
-	if (!has_resv1 && has_resv2)
+	if (!job_rec1->has_resv && job_rec2->has_resv)
 		return 1;
 
 	if (job_rec1->part_ptr && job_rec2->part_ptr) {
-		p1 = job_rec1->part_ptr->priority;
-		p2 = job_rec2->part_ptr->priority;
-		if (p1 < p2)
+		if (job_rec1->part_prio < job_rec2->part_prio)
 			return 1;
-		if (p1 > p2)
+		if (job_rec1->part_prio > job_rec2->part_prio)
 			return -1;
 	}
 
-	if (job_rec1->job_ptr->part_ptr_list &&
-	    job_rec1->job_ptr->priority_array)
-		p1 = job_rec1->priority;
-	else
-		p1 = job_rec1->job_ptr->priority;
-
-
-	if (job_rec2->job_ptr->part_ptr_list &&
-	    job_rec2->job_ptr->priority_array)
-		p2 = job_rec2->priority;
-	else
-		p2 = job_rec2->job_ptr->priority;
-
-
-	if (p1 < p2)
+	if (job_rec1->priority < job_rec2->priority)
 		return 1;
-	if (p1 > p2)
+	if (job_rec1->priority > job_rec2->priority)
 		return -1;
 
 	/* If the priorities are the same sort by increasing job id's */
@@ -1864,13 +2014,11 @@ static void _depend_list2str(struct job_record *job_ptr)
  */
 extern int test_job_dependency(struct job_record *job_ptr)
 {
-	ListIterator depend_iter, job_iterator;
+	ListIterator depend_iter;
 	struct depend_spec *dep_ptr;
 	bool failure = false, depends = false, rebuild_str = false;
- 	List job_queue = NULL;
- 	bool run_now;
 	int results = 0;
-	struct job_record *qjob_ptr, *djob_ptr;
+	struct job_record *djob_ptr;
 	time_t now = time(NULL);
 	/* For performance reasons with job arrays, we cache dependency
 	 * results and re-use them whenever possible */
@@ -1907,31 +2055,12 @@ extern int test_job_dependency(struct job_record *job_ptr)
 							dep_ptr->array_task_id);
 		}
 		djob_ptr = dep_ptr->job_ptr;
- 		if ((dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) &&
- 		    job_ptr->name) {
- 			/* get user jobs with the same user and name */
- 			job_queue = _build_user_job_list(job_ptr->user_id,
-							 job_ptr->name);
- 			run_now = true;
-			job_iterator = list_iterator_create(job_queue);
-			while ((qjob_ptr = (struct job_record *)
-					   list_next(job_iterator))) {
-				/* already running/suspended job or previously
-				 * submitted pending job */
-				if (IS_JOB_RUNNING(qjob_ptr) ||
-				    IS_JOB_SUSPENDED(qjob_ptr) ||
-				    (IS_JOB_PENDING(qjob_ptr) &&
-				     (qjob_ptr->job_id < job_ptr->job_id))) {
-					run_now = false;
-					break;
- 				}
- 			}
-			list_iterator_destroy(job_iterator);
-			list_destroy(job_queue);
+		if ((dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) &&
+		    job_ptr->name) {
 			/* job can run now, delete dependency */
- 			if (run_now)
- 				list_delete_item(depend_iter);
- 			else
+			if (!_singleton_blocked(job_ptr))
+				list_delete_item(depend_iter);
+			else
 				depends = true;
 		} else if ((djob_ptr == NULL) ||
 			   (djob_ptr->magic != JOB_MAGIC) ||
@@ -1942,9 +2071,8 @@ extern int test_job_dependency(struct job_record *job_ptr)
 		} else if ((djob_ptr->array_task_id == INFINITE) &&
 			   (djob_ptr->array_recs != NULL)) {
 			bool array_complete, array_completed, array_pending;
-			array_complete=test_job_array_complete(dep_ptr->job_id);
-			array_completed=test_job_array_completed(dep_ptr->job_id);
-			array_pending  =test_job_array_pending(dep_ptr->job_id);
+			_get_array_state(dep_ptr->job_id, now, &array_complete,
+					 &array_completed, &array_pending);
 			/* Special case, apply test to job array as a whole */
 			if (dep_ptr->depend_type == SLURM_DEPEND_AFTER) {
 				if (!array_pending)
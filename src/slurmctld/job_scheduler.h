@@ -50,6 +50,8 @@ typedef struct job_queue_rec {
 	struct part_record *part_ptr;	/* Pointer to partition record. Each
 					 * job may have multiple partitions. */
 	uint32_t priority;		/* Job priority in THIS partition */
+	uint32_t part_prio;		/* Partition priority */
+	bool has_resv;			/* Job has an advanced reservation */
 } job_queue_rec_t;
 
 /*
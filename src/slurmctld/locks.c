@@ -52,8 +52,20 @@
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
 
-static pthread_mutex_t locks_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t locks_cond = PTHREAD_COND_INITIALIZER;
+/* Each entity (config, job, node, partition) has its own mutex and
+ * condition variable so that contention on one entity (typically the job
+ * lock) does not serialize or wake up threads waiting on the others. */
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+} entity_lock_t;
+
+static entity_lock_t entity_locks[ENTITY_COUNT] = {
+	{ PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER },
+	{ PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER },
+	{ PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER },
+	{ PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER }
+};
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static slurmctld_lock_flags_t slurmctld_locks;
@@ -68,8 +80,14 @@ static void _wr_wrunlock(lock_datatype_t datatype);
  *	control */
 void init_locks(void)
 {
+	int i;
+
 	/* just clear all semaphores */
+	for (i = 0; i < ENTITY_COUNT; i++)
+		slurm_mutex_lock(&entity_locks[i].mutex);
 	memset((void *) &slurmctld_locks, 0, sizeof(slurmctld_locks));
+	for (i = ENTITY_COUNT - 1; i >= 0; i--)
+		slurm_mutex_unlock(&entity_locks[i].mutex);
 }
 
 /* lock_slurmctld - Issue the required lock requests in a well defined order */
@@ -195,9 +213,10 @@ extern void unlock_slurmctld(slurmctld_lock_t lock_levels)
  *	deadlock has been observed with some values for the count. */
 static bool _wr_rdlock(lock_datatype_t datatype, bool wait_lock)
 {
+	entity_lock_t *ent = &entity_locks[datatype];
 	bool success = true;
 
-	slurm_mutex_lock(&locks_mutex);
+	slurm_mutex_lock(&ent->mutex);
 	while (1) {
 #if 1
 		if ((slurmctld_locks.entity[write_lock(datatype)] == 0) &&
@@ -215,30 +234,38 @@ static bool _wr_rdlock(lock_datatype_t datatype, bool wait_lock)
 			success = false;
 			break;
 		} else {	/* wait for state change and retry */
-			pthread_cond_wait(&locks_cond, &locks_mutex);
+			pthread_cond_wait(&ent->cond, &ent->mutex);
 			if (kill_thread)
 				pthread_exit(NULL);
 		}
 	}
-	slurm_mutex_unlock(&locks_mutex);
+	slurm_mutex_unlock(&ent->mutex);
 	return success;
 }
 
-/* _wr_rdunlock - Issue a read unlock on the specified data type */
+/* _wr_rdunlock - Issue a read unlock on the specified data type
+ *	Only writers ever wait for readers to drain, so waiting threads are
+ *	only woken when the last reader releases the lock and a writer is
+ *	pending. */
 static void _wr_rdunlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
+	entity_lock_t *ent = &entity_locks[datatype];
+
+	slurm_mutex_lock(&ent->mutex);
 	slurmctld_locks.entity[read_lock(datatype)]--;
-	pthread_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	if ((slurmctld_locks.entity[read_lock(datatype)] == 0) &&
+	    (slurmctld_locks.entity[write_wait_lock(datatype)] != 0))
+		pthread_cond_broadcast(&ent->cond);
+	slurm_mutex_unlock(&ent->mutex);
 }
 
 /* _wr_wrlock - Issue a write lock on the specified data type */
 static bool _wr_wrlock(lock_datatype_t datatype, bool wait_lock)
 {
+	entity_lock_t *ent = &entity_locks[datatype];
 	bool success = true;
 
-	slurm_mutex_lock(&locks_mutex);
+	slurm_mutex_lock(&ent->mutex);
 	slurmctld_locks.entity[write_wait_lock(datatype)]++;
 
 	while (1) {
@@ -250,41 +277,61 @@ static bool _wr_wrlock(lock_datatype_t datatype, bool wait_lock)
 			break;
 		} else if (!wait_lock) {
 			slurmctld_locks.entity[write_wait_lock(datatype)]--;
+			/* Readers blocked behind this pending write may now
+			 * proceed */
+			if (slurmctld_locks.entity[write_wait_lock(datatype)]
+			    == 0)
+				pthread_cond_broadcast(&ent->cond);
 			success = false;
 			break;
 		} else {	/* wait for state change and retry */
-			pthread_cond_wait(&locks_cond, &locks_mutex);
+			pthread_cond_wait(&ent->cond, &ent->mutex);
 			if (kill_thread)
 				pthread_exit(NULL);
 		}
 	}
-	slurm_mutex_unlock(&locks_mutex);
+	slurm_mutex_unlock(&ent->mutex);
 	return success;
 }
 
 /* _wr_wrunlock - Issue a write unlock on the specified data type */
 static void _wr_wrunlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
+	entity_lock_t *ent = &entity_locks[datatype];
+
+	slurm_mutex_lock(&ent->mutex);
 	slurmctld_locks.entity[write_lock(datatype)]--;
-	pthread_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	pthread_cond_broadcast(&ent->cond);
+	slurm_mutex_unlock(&ent->mutex);
 }
 
 /* get_lock_values - Get the current value of all locks
  * OUT lock_flags - a copy of the current lock values */
 void get_lock_values(slurmctld_lock_flags_t * lock_flags)
 {
+	int i;
+
 	xassert(lock_flags);
-	memcpy((void *) lock_flags, (void *) &slurmctld_locks,
-	       sizeof(slurmctld_locks));
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		slurm_mutex_lock(&entity_locks[i].mutex);
+		memcpy((void *) &lock_flags->entity[i * 4],
+		       (void *) &slurmctld_locks.entity[i * 4],
+		       sizeof(int) * 4);
+		slurm_mutex_unlock(&entity_locks[i].mutex);
+	}
 }
 
 /* kill_locked_threads - Kill all threads waiting on semaphores */
 extern void kill_locked_threads(void)
 {
+	int i;
+
 	kill_thread = 1;
-	pthread_cond_broadcast(&locks_cond);
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		slurm_mutex_lock(&entity_locks[i].mutex);
+		pthread_cond_broadcast(&entity_locks[i].cond);
+		slurm_mutex_unlock(&entity_locks[i].mutex);
+	}
 }
 
 /* un/lock semaphore used for saving state of slurmctld */
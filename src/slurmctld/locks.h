@@ -82,6 +82,15 @@
  * For example: no lock on the config data structure, read lock on the job
  * and node data structures, and write lock on the partition data structure
  * would look like this: "{ NO_LOCK, READ_LOCK, READ_LOCK, WRITE_LOCK }"
+ *
+ * Lock ordering: locks are always acquired in the order config, job, node,
+ * partition and released in the reverse order. Any other lock in slurmctld
+ * (e.g. the assoc_mgr locks or the state file mutex) must be acquired after
+ * the slurmctld locks it is nested within, never before.
+ *
+ * Each entity is protected by its own mutex and condition variable, so a
+ * thread blocked on (or releasing) the job lock never contends with or wakes
+ * up threads waiting only on the node or partition locks.
 \*****************************************************************************/
 
 #ifndef _SLURMCTLD_LOCKS_H
@@ -95,6 +95,10 @@ bitstr_t *idle_node_bitmap  = NULL;	/* bitmap of idle nodes */
 bitstr_t *power_node_bitmap = NULL;	/* bitmap of powered down nodes */
 bitstr_t *share_node_bitmap = NULL;  	/* bitmap of sharable nodes */
 bitstr_t *up_node_bitmap    = NULL;  	/* bitmap of non-down nodes */
+uint32_t node_config_update_cnt = 0;	/* count of node feature, gres and
+					 * weight changes */
+uint32_t node_usage_update_cnt = 0;	/* count of job allocation changes
+					 * on nodes */
 
 static void 	_dump_node_state (struct node_record *dump_node_ptr,
 				  Buf buffer);
@@ -276,7 +280,7 @@ extern int load_all_node_state ( bool state_only )
 	char *comm_name = NULL, *node_hostname = NULL;
 	char *node_name = NULL, *reason = NULL, *data = NULL, *state_file;
 	char *features = NULL, *gres = NULL, *cpu_spec_list = NULL;
-	int data_allocated, data_read = 0, error_code = 0, node_cnt = 0;
+	int error_code = 0, node_cnt = 0;
 	uint16_t node_state2, core_spec_cnt = 0;
 	uint32_t node_state;
 	uint16_t cpus = 1, boards = 1, sockets = 1, cores = 1, threads = 1;
@@ -292,11 +296,13 @@ extern int load_all_node_state ( bool state_only )
 	hostset_t hs = NULL;
 	bool power_save_mode = false;
 	uint16_t protocol_version = (uint16_t)NO_VAL;
+	DEF_TIMERS;
 
 	if (slurmctld_conf.suspend_program && slurmctld_conf.resume_program)
 		power_save_mode = true;
 
 	/* read the file */
+	START_TIMER;
 	lock_state_files ();
 	state_fd = _open_node_state_file(&state_file);
 	if (state_fd < 0) {
@@ -304,24 +310,7 @@ extern int load_all_node_state ( bool state_only )
 		error_code = ENOENT;
 	}
 	else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size], BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error ("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		data = read_state_file(state_fd, state_file, 0, &data_size);
 		close (state_fd);
 	}
 	xfree (state_file);
@@ -639,7 +628,8 @@ extern int load_all_node_state ( bool state_only )
 		xfree(reason);
 	}
 
-fini:	info("Recovered state of %d nodes", node_cnt);
+fini:	END_TIMER2("load_all_node_state");
+	info("Recovered state of %d nodes %s", node_cnt, TIME_STR);
 	if (hs) {
 		char node_names[128];
 		hostset_ranged_string(hs, sizeof(node_names), node_names);
@@ -1598,6 +1588,7 @@ static int _update_node_weight(char *node_names, uint32_t weight)
 	list_iterator_destroy(config_iterator);
 	FREE_NULL_BITMAP(node_bitmap);
 
+	node_config_update_cnt++;
 	info("_update_node_weight: nodes %s weight set to: %u",
 		node_names, weight);
 	return SLURM_SUCCESS;
@@ -1671,6 +1662,7 @@ static int _update_node_features(char *node_names, char *features)
 	list_iterator_destroy(config_iterator);
 	FREE_NULL_BITMAP(node_bitmap);
 
+	node_config_update_cnt++;
 	info("_update_node_features: nodes %s features set to: %s",
 		node_names, features);
 	return SLURM_SUCCESS;
@@ -1756,6 +1748,7 @@ static int _update_node_gres(char *node_names, char *gres)
 	}
 	FREE_NULL_BITMAP(node_bitmap);
 
+	node_config_update_cnt++;
 	info("_update_node_gres: nodes %s gres set to: %s", node_names, gres);
 	return SLURM_SUCCESS;
 }
@@ -3083,6 +3076,7 @@ extern void make_node_alloc(struct node_record *node_ptr,
 	node_ptr->reason_time = 0;
 	node_ptr->reason_uid = NO_VAL;
 
+	node_usage_update_cnt++;
 	last_node_update = time (NULL);
 }
 
@@ -3152,6 +3146,7 @@ extern void make_node_comp(struct node_record *node_ptr,
 		node_ptr->node_state = NODE_STATE_IDLE | node_flags;
 		node_ptr->last_idle = now;
 	}
+	node_usage_update_cnt++;
 	last_node_update = now;
 }
 
@@ -3206,6 +3201,7 @@ void make_node_idle(struct node_record *node_ptr,
 		/* Not a replay */
 		last_job_update = now;
 		bit_clear(node_bitmap, inx);
+		node_usage_update_cnt++;
 
 		job_update_cpu_cnt(job_ptr, inx);
 
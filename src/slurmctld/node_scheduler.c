@@ -1237,10 +1237,8 @@ _pick_best_nodes(struct node_set *node_set_ptr, int node_set_size,
 					bit_and(node_set_ptr[i].my_bitmap,
 						share_node_bitmap);
 #ifndef HAVE_BG
-					bit_not(cg_node_bitmap);
-					bit_and(node_set_ptr[i].my_bitmap,
+					bit_and_not(node_set_ptr[i].my_bitmap,
 						cg_node_bitmap);
-					bit_not(cg_node_bitmap);
 #endif
 				} else {
 					bit_and(node_set_ptr[i].my_bitmap,
@@ -1249,10 +1247,8 @@ _pick_best_nodes(struct node_set *node_set_ptr, int node_set_size,
 				}
 			} else {
 #ifndef HAVE_BG
-				bit_not(cg_node_bitmap);
-				bit_and(node_set_ptr[i].my_bitmap,
+				bit_and_not(node_set_ptr[i].my_bitmap,
 					cg_node_bitmap);
-				bit_not(cg_node_bitmap);
 #endif
 			}
 			if (!nodes_busy) {
@@ -2334,9 +2330,8 @@ static int _build_node_list(struct job_record *job_ptr,
 	node_set_ptr[node_set_inx+1].my_bitmap = NULL;
 	if (detail_ptr->exc_node_bitmap) {
 		if (usable_node_mask) {
-			bit_not(detail_ptr->exc_node_bitmap);
-			bit_and(usable_node_mask, detail_ptr->exc_node_bitmap);
-			bit_not(detail_ptr->exc_node_bitmap);
+			bit_and_not(usable_node_mask,
+				detail_ptr->exc_node_bitmap);
 		} else {
 			usable_node_mask =
 				bit_copy(detail_ptr->exc_node_bitmap);
@@ -58,6 +58,7 @@
 #include "src/common/list.h"
 #include "src/common/node_select.h"
 #include "src/common/pack.h"
+#include "src/common/timers.h"
 #include "src/common/uid.h"
 #include "src/common/xstring.h"
 
@@ -492,15 +493,17 @@ int load_all_part_state(void)
 	uint16_t max_share, preempt_mode, priority, state_up, cr_type;
 	struct part_record *part_ptr;
 	uint32_t data_size = 0, name_len;
-	int data_allocated, data_read = 0, error_code = 0, part_cnt = 0;
+	int error_code = 0, part_cnt = 0;
 	int state_fd;
 	Buf buffer;
 	char *ver_str = NULL;
 	char* allow_alloc_nodes = NULL;
 	uint16_t protocol_version = (uint16_t)NO_VAL;
 	char* alternate = NULL;
+	DEF_TIMERS;
 
 	/* read the file */
+	START_TIMER;
 	lock_state_files();
 	state_fd = _open_part_state_file(&state_file);
 	if (state_fd < 0) {
@@ -508,25 +511,7 @@ int load_all_part_state(void)
 		     state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if  (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		data = read_state_file(state_fd, state_file, 0, &data_size);
 		close(state_fd);
 	}
 	xfree(state_file);
@@ -720,13 +705,15 @@ int load_all_part_state(void)
 		xfree(part_name);
 	}
 
-	info("Recovered state of %d partitions", part_cnt);
+	END_TIMER2("load_all_part_state");
+	info("Recovered state of %d partitions %s", part_cnt, TIME_STR);
 	free_buf(buffer);
 	return error_code;
 
       unpack_error:
 	error("Incomplete partition data checkpoint file");
-	info("Recovered state of %d partitions", part_cnt);
+	END_TIMER2("load_all_part_state");
+	info("Recovered state of %d partitions %s", part_cnt, TIME_STR);
 	free_buf(buffer);
 	return EFAULT;
 }
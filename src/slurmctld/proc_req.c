@@ -103,8 +103,54 @@ static uint32_t *rpc_user_id = NULL;
 static uint32_t *rpc_user_cnt = NULL;
 static uint64_t *rpc_user_time = NULL;
 
+static pthread_mutex_t epilog_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List epilog_list = NULL;		/* epilog_complete_msg_t to process */
+static bool epilog_draining = false;	/* a thread is processing epilog_list */
+
+/* Maximum number of queued epilog complete messages processed under one
+ * hold of the job write lock, other RPCs can get the locks in between */
+#define EPILOG_BATCH_MAX 64
+
 static pthread_mutex_t throttle_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t throttle_cond = PTHREAD_COND_INITIALIZER;
+static int throttle_wait_cnt = 0;	/* RPCs waiting in _throttle_start() */
+
+/* Once this many server threads are queued behind the RPC throttles, new
+ * job submission and allocation requests are rejected with EAGAIN (which
+ * the clients retry) rather than consuming more server threads, so that
+ * cheap RPCs can still be accepted and processed */
+#ifndef THROTTLE_SHED_CNT
+#define THROTTLE_SHED_CNT (MAX_SERVER_THREADS / 2)
+#endif
+
+/* Cache of packed REQUEST_JOB_INFO, REQUEST_NODE_INFO and
+ * REQUEST_PARTITION_INFO responses. Each entry records the update times of
+ * the data it was built from, so that any number of clients polling with
+ * the same parameters can share one packing pass until the underlying
+ * records change. Packed buffers are reference counted so that a buffer can
+ * be replaced in the cache while other threads are still sending it. */
+#define PACK_CACHE_SIZE 8
+
+typedef struct {
+	char *data;
+	int data_size;
+	int ref_cnt;
+} pack_cache_buf_t;
+
+typedef struct {
+	pack_cache_buf_t *buf;
+	time_t pack_time;	/* when the buffer was packed */
+	time_t last_used;
+	time_t update_time[4];	/* config, job, node and partition */
+	uint16_t protocol_version;
+	uint16_t show_flags;
+	char *part_key;		/* see _pack_cache_part_key() */
+} pack_cache_ent_t;
+
+static pthread_mutex_t pack_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pack_cache_ent_t job_pack_cache[PACK_CACHE_SIZE];
+static pack_cache_ent_t node_pack_cache[PACK_CACHE_SIZE];
+static pack_cache_ent_t part_pack_cache[PACK_CACHE_SIZE];
 
 static void         _fill_ctld_conf(slurm_ctl_conf_t * build_ptr);
 static void         _kill_job_on_msg_fail(uint32_t job_id);
@@ -115,8 +161,21 @@ static int 	    _launch_batch_step(job_desc_msg_t *job_desc_msg,
 static int          _make_step_cred(struct step_record *step_rec,
 				    slurm_cred_t **slurm_cred,
 				    uint16_t protocol_version);
+static pack_cache_buf_t *_pack_cache_get(pack_cache_ent_t *cache,
+					 char *part_key, uint16_t show_flags,
+					 uint16_t protocol_version,
+					 time_t *update_time);
+static pack_cache_buf_t *_pack_cache_put(pack_cache_ent_t *cache,
+					 char *part_key, uint16_t show_flags,
+					 uint16_t protocol_version,
+					 time_t *update_time, time_t pack_time,
+					 char *data, int data_size);
+static void         _pack_cache_ent_clear(pack_cache_ent_t *ent);
+static char *       _pack_cache_part_key(uid_t uid, uint16_t show_flags);
+static void         _pack_cache_release(pack_cache_buf_t *buf);
 static void         _throttle_fini(int *active_rpc_cnt);
 static void         _throttle_start(int *active_rpc_cnt);
+static int          _throttle_try_start(int *active_rpc_cnt);
 
 inline static void  _slurm_rpc_accounting_first_reg(slurm_msg_t *msg);
 inline static void  _slurm_rpc_accounting_register_ctld(slurm_msg_t *msg);
@@ -565,11 +624,39 @@ static void _throttle_start(int *active_rpc_cnt)
 			(*active_rpc_cnt)++;
 			break;
 		}
+		throttle_wait_cnt++;
 		pthread_cond_wait(&throttle_cond, &throttle_mutex);
+		throttle_wait_cnt--;
 	}
 	slurm_mutex_unlock(&throttle_mutex);
 	usleep(1);
 }
+/* _throttle_try_start - equivalent to _throttle_start() for RPCs which the
+ *	client will retry, except that rather than queuing behind an already
+ *	long backlog of throttled RPCs, the request is rejected
+ * RET SLURM_SUCCESS or EAGAIN if the RPC should be rejected */
+static int _throttle_try_start(int *active_rpc_cnt)
+{
+	static time_t last_log_time = 0;
+	time_t now;
+
+	slurm_mutex_lock(&throttle_mutex);
+	if ((*active_rpc_cnt != 0) &&
+	    (throttle_wait_cnt >= THROTTLE_SHED_CNT)) {
+		now = time(NULL);
+		if (difftime(now, last_log_time) > 2) {
+			verbose("%d RPCs waiting on throttle, rejecting "
+				"request with EAGAIN", throttle_wait_cnt);
+			last_log_time = now;
+		}
+		slurm_mutex_unlock(&throttle_mutex);
+		return EAGAIN;
+	}
+	slurm_mutex_unlock(&throttle_mutex);
+
+	_throttle_start(active_rpc_cnt);
+	return SLURM_SUCCESS;
+}
 static void _throttle_fini(int *active_rpc_cnt)
 {
 	slurm_mutex_lock(&throttle_mutex);
@@ -1009,9 +1096,10 @@ static void _slurm_rpc_allocate_resources(slurm_msg_t * msg)
 		slurm_get_ip_str(&resp_addr, &port,
 				 job_desc_msg->resp_host, 16);
 		dump_job_desc(job_desc_msg);
+		if (error_code == SLURM_SUCCESS)
+			error_code = _throttle_try_start(&active_rpc_cnt);
 		if (error_code == SLURM_SUCCESS) {
 			do_unlock = true;
-			_throttle_start(&active_rpc_cnt);
 			lock_slurmctld(job_write_lock);
 
 			error_code = job_allocate(job_desc_msg, immediate,
@@ -1152,6 +1240,173 @@ static void _slurm_rpc_dump_conf(slurm_msg_t * msg)
 	}
 }
 
+/* _pack_cache_valid - Test if a cache entry was packed from the current
+ *	state of the records identified by update_time. Records may be
+ *	updated more than once within the second of their last update time,
+ *	so the entry is only valid if it was packed after that second. */
+static bool _pack_cache_valid(pack_cache_ent_t *ent, time_t *update_time)
+{
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		if (ent->update_time[i] != update_time[i])
+			return false;
+		if (ent->pack_time <= update_time[i])
+			return false;
+	}
+	return true;
+}
+
+/* _pack_cache_part_key - Identify the partitions hidden from a user
+ *	because of their group access. Responses packed for users who are
+ *	denied the same partitions are identical, so they share cache
+ *	entries.
+ * IN uid, show_flags - as supplied in the request
+ * RET NULL if no partitions are filtered for this request, otherwise
+ *	a string naming the partitions, which the caller must xfree()
+ * NOTE: READ lock_slurmctld partitions before entry */
+static char *_pack_cache_part_key(uid_t uid, uint16_t show_flags)
+{
+	struct part_record *part_ptr;
+	ListIterator part_iterator;
+	char *part_key;
+
+	if ((show_flags & SHOW_ALL) || (uid == 0))
+		return NULL;
+
+	part_key = xstrdup("");
+	part_iterator = list_iterator_create(part_list);
+	while ((part_ptr = (struct part_record *) list_next(part_iterator))) {
+		if (validate_group(part_ptr, uid) == 0)
+			xstrfmtcat(part_key, "%s,", part_ptr->name);
+	}
+	list_iterator_destroy(part_iterator);
+
+	return part_key;
+}
+
+/* _pack_cache_ent_clear - Release a cache entry's buffer and key
+ * NOTE: pack_cache_mutex must be locked by the caller */
+static void _pack_cache_ent_clear(pack_cache_ent_t *ent)
+{
+	if (ent->buf && (--ent->buf->ref_cnt == 0)) {
+		xfree(ent->buf->data);
+		xfree(ent->buf);
+	}
+	ent->buf = NULL;
+	xfree(ent->part_key);
+}
+
+/* _pack_cache_get - Find a packed response buffer matching the request.
+ *	Entries which are no longer valid are released.
+ * IN cache - cache for the RPC type
+ * IN part_key - from _pack_cache_part_key()
+ * IN show_flags, protocol_version - as supplied in the request
+ * IN update_time - current config, job, node and partition update times,
+ *	zero for records the response does not depend upon
+ * RET buffer or NULL if none, release with _pack_cache_release() */
+static pack_cache_buf_t *_pack_cache_get(pack_cache_ent_t *cache,
+					 char *part_key, uint16_t show_flags,
+					 uint16_t protocol_version,
+					 time_t *update_time)
+{
+	pack_cache_buf_t *buf = NULL;
+	int i;
+
+	slurm_mutex_lock(&pack_cache_mutex);
+	for (i = 0; i < PACK_CACHE_SIZE; i++) {
+		if (!cache[i].buf)
+			continue;
+		if (!_pack_cache_valid(&cache[i], update_time)) {
+			_pack_cache_ent_clear(&cache[i]);
+			continue;
+		}
+		if (buf || xstrcmp(cache[i].part_key, part_key) ||
+		    (cache[i].show_flags != show_flags) ||
+		    (cache[i].protocol_version != protocol_version))
+			continue;
+		buf = cache[i].buf;
+		buf->ref_cnt++;
+		cache[i].last_used = time(NULL);
+	}
+	slurm_mutex_unlock(&pack_cache_mutex);
+
+	return buf;
+}
+
+/* _pack_cache_put - Record a newly packed response buffer in the cache.
+ *	The cache takes ownership of data, which must have been packed at
+ *	pack_time while holding the locks for the records in update_time.
+ * RET buffer to send, release with _pack_cache_release() */
+static pack_cache_buf_t *_pack_cache_put(pack_cache_ent_t *cache,
+					 char *part_key, uint16_t show_flags,
+					 uint16_t protocol_version,
+					 time_t *update_time, time_t pack_time,
+					 char *data, int data_size)
+{
+	pack_cache_buf_t *buf;
+	pack_cache_ent_t *ent = NULL;
+	int i;
+
+	buf = xmalloc(sizeof(pack_cache_buf_t));
+	buf->data = data;
+	buf->data_size = data_size;
+	buf->ref_cnt = 2;	/* one for the cache, one for the caller */
+
+	slurm_mutex_lock(&pack_cache_mutex);
+	/* Replace an entry for the same request, else an empty or stale
+	 * entry, else the least recently used one */
+	for (i = 0; i < PACK_CACHE_SIZE; i++) {
+		if (!cache[i].buf ||
+		    (!xstrcmp(cache[i].part_key, part_key) &&
+		     (cache[i].show_flags == show_flags) &&
+		     (cache[i].protocol_version == protocol_version)) ||
+		    !_pack_cache_valid(&cache[i], update_time)) {
+			ent = &cache[i];
+			break;
+		}
+		if (!ent || (cache[i].last_used < ent->last_used))
+			ent = &cache[i];
+	}
+	_pack_cache_ent_clear(ent);
+	ent->buf = buf;
+	ent->pack_time = pack_time;
+	ent->last_used = pack_time;
+	memcpy(ent->update_time, update_time, sizeof(ent->update_time));
+	ent->protocol_version = protocol_version;
+	ent->show_flags = show_flags;
+	ent->part_key = xstrdup(part_key);
+	slurm_mutex_unlock(&pack_cache_mutex);
+
+	return buf;
+}
+
+/* _pack_cache_release - Release a buffer from _pack_cache_get() or
+ *	_pack_cache_put() */
+static void _pack_cache_release(pack_cache_buf_t *buf)
+{
+	slurm_mutex_lock(&pack_cache_mutex);
+	if (--buf->ref_cnt == 0) {
+		xfree(buf->data);
+		xfree(buf);
+	}
+	slurm_mutex_unlock(&pack_cache_mutex);
+}
+
+/* Free job, node and partition information packed for reuse */
+extern void pack_cache_fini(void)
+{
+	int i;
+
+	slurm_mutex_lock(&pack_cache_mutex);
+	for (i = 0; i < PACK_CACHE_SIZE; i++) {
+		_pack_cache_ent_clear(&job_pack_cache[i]);
+		_pack_cache_ent_clear(&node_pack_cache[i]);
+		_pack_cache_ent_clear(&part_pack_cache[i]);
+	}
+	slurm_mutex_unlock(&pack_cache_mutex);
+}
+
 /* _slurm_rpc_dump_jobs - process RPC for job state information */
 static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 {
@@ -1161,43 +1416,97 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 	slurm_msg_t response_msg;
 	job_info_request_msg_t *job_info_request_msg =
 		(job_info_request_msg_t *) msg->data;
+	/* Locks: Read config, read partition (for hiding) */
+	slurmctld_lock_t config_read_lock = {
+		READ_LOCK, NO_LOCK, NO_LOCK, READ_LOCK };
 	/* Locks: Read config job, write node (for hiding) */
 	slurmctld_lock_t job_read_lock = {
 		READ_LOCK, READ_LOCK, NO_LOCK, WRITE_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
+	uint16_t show_flags = job_info_request_msg->show_flags;
+	pack_cache_buf_t *cache_buf = NULL;
+	time_t pack_time, update_time[4];
+	char *part_key = NULL;
+	bool use_cache;
 
 	START_TIMER;
 	debug3("Processing RPC: REQUEST_JOB_INFO from uid=%d", uid);
+
+	/* The batch script is only packed for its owner and private jobs
+	 * depend upon the requester's coordinator status, so such requests
+	 * are never cached. Otherwise the response only depends upon the
+	 * user through the partitions hidden from them. */
+	lock_slurmctld(config_read_lock);
+	use_cache = !(show_flags & SHOW_DETAIL2) &&
+		    !(slurmctld_conf.private_data & PRIVATE_DATA_JOBS);
+	update_time[0] = slurmctld_conf.last_update;
+	update_time[1] = last_job_update;
+	update_time[2] = 0;
+	update_time[3] = last_part_update;
+	if (use_cache &&
+	    ((job_info_request_msg->last_update - 1) < last_job_update)) {
+		part_key = _pack_cache_part_key(uid, show_flags);
+		cache_buf = _pack_cache_get(job_pack_cache, part_key,
+					    show_flags, msg->protocol_version,
+					    update_time);
+		xfree(part_key);
+	}
+	unlock_slurmctld(config_read_lock);
+
+	if (cache_buf)
+		goto send_msg;
+
 	lock_slurmctld(job_read_lock);
 
 	if ((job_info_request_msg->last_update - 1) >= last_job_update) {
 		unlock_slurmctld(job_read_lock);
 		debug3("_slurm_rpc_dump_jobs, no change");
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
-	} else {
-		pack_all_jobs(&dump, &dump_size,
-			      job_info_request_msg->show_flags,
-			      g_slurm_auth_get_uid(msg->auth_cred, NULL),
-			      NO_VAL, msg->protocol_version);
-		unlock_slurmctld(job_read_lock);
-		END_TIMER2("_slurm_rpc_dump_jobs");
+		return;
+	}
+
+	update_time[0] = slurmctld_conf.last_update;
+	update_time[1] = last_job_update;
+	update_time[3] = last_part_update;
+	pack_time = time(NULL);
+	pack_all_jobs(&dump, &dump_size, show_flags, uid, NO_VAL,
+		      msg->protocol_version);
+	if (use_cache) {
+		part_key = _pack_cache_part_key(uid, show_flags);
+		cache_buf = _pack_cache_put(job_pack_cache, part_key,
+					    show_flags, msg->protocol_version,
+					    update_time, pack_time,
+					    dump, dump_size);
+		xfree(part_key);
+	}
+	unlock_slurmctld(job_read_lock);
+
+send_msg:
+	END_TIMER2("_slurm_rpc_dump_jobs");
 #if 0
-		info("_slurm_rpc_dump_jobs, size=%d %s", dump_size, TIME_STR);
+	info("_slurm_rpc_dump_jobs, size=%d %s", dump_size, TIME_STR);
 #endif
 
-		/* init response_msg structure */
-		slurm_msg_t_init(&response_msg);
-		response_msg.flags = msg->flags;
-		response_msg.protocol_version = msg->protocol_version;
-		response_msg.address = msg->address;
-		response_msg.msg_type = RESPONSE_JOB_INFO;
+	/* init response_msg structure */
+	slurm_msg_t_init(&response_msg);
+	response_msg.flags = msg->flags;
+	response_msg.protocol_version = msg->protocol_version;
+	response_msg.address = msg->address;
+	response_msg.msg_type = RESPONSE_JOB_INFO;
+	if (cache_buf) {
+		response_msg.data = cache_buf->data;
+		response_msg.data_size = cache_buf->data_size;
+	} else {
 		response_msg.data = dump;
 		response_msg.data_size = dump_size;
+	}
 
-		/* send message */
-		slurm_send_node_msg(msg->conn_fd, &response_msg);
+	/* send message */
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	if (cache_buf)
+		_pack_cache_release(cache_buf);
+	else
 		xfree(dump);
-	}
 }
 
 /* _slurm_rpc_dump_jobs - process RPC for job state information */
@@ -1429,53 +1738,90 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t * msg)
 	slurm_msg_t response_msg;
 	node_info_request_msg_t *node_req_msg =
 		(node_info_request_msg_t *) msg->data;
+	/* Locks: Read config, read partition (for hiding) */
+	slurmctld_lock_t config_read_lock = {
+		READ_LOCK, NO_LOCK, NO_LOCK, READ_LOCK };
 	/* Locks: Read config, write node (reset allocated CPU count in some
-	 * select plugins) */
+	 * select plugins), read partition (for hiding) */
 	slurmctld_lock_t node_write_lock = {
-		READ_LOCK, NO_LOCK, WRITE_LOCK, NO_LOCK };
+		READ_LOCK, NO_LOCK, WRITE_LOCK, READ_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
+	uint16_t show_flags = node_req_msg->show_flags;
+	pack_cache_buf_t *cache_buf = NULL;
+	time_t pack_time, update_time[4];
+	char *part_key = NULL;
 
 	START_TIMER;
 	debug3("Processing RPC: REQUEST_NODE_INFO from uid=%d", uid);
-	lock_slurmctld(node_write_lock);
+	lock_slurmctld(config_read_lock);
 
 	if ((slurmctld_conf.private_data & PRIVATE_DATA_NODES) &&
 	    (!validate_operator(uid))) {
-		unlock_slurmctld(node_write_lock);
+		unlock_slurmctld(config_read_lock);
 		error("Security violation, REQUEST_NODE_INFO RPC from uid=%d",
 		      uid);
 		slurm_send_rc_msg(msg, ESLURM_ACCESS_DENIED);
 		return;
 	}
 
+	update_time[0] = slurmctld_conf.last_update;
+	update_time[1] = 0;
+	update_time[2] = last_node_update;
+	update_time[3] = last_part_update;
+	if ((node_req_msg->last_update - 1) < last_node_update) {
+		part_key = _pack_cache_part_key(uid, show_flags);
+		cache_buf = _pack_cache_get(node_pack_cache, part_key,
+					    show_flags, msg->protocol_version,
+					    update_time);
+		xfree(part_key);
+	}
+	unlock_slurmctld(config_read_lock);
+
+	if (cache_buf)
+		goto send_msg;
+
+	lock_slurmctld(node_write_lock);
+
 	select_g_select_nodeinfo_set_all();
 
 	if ((node_req_msg->last_update - 1) >= last_node_update) {
 		unlock_slurmctld(node_write_lock);
 		debug3("_slurm_rpc_dump_nodes, no change");
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
-	} else {
-		pack_all_node(&dump, &dump_size, node_req_msg->show_flags,
-			      uid, msg->protocol_version);
-		unlock_slurmctld(node_write_lock);
-		END_TIMER2("_slurm_rpc_dump_nodes");
+		return;
+	}
+
+	update_time[0] = slurmctld_conf.last_update;
+	update_time[2] = last_node_update;
+	update_time[3] = last_part_update;
+	pack_time = time(NULL);
+	pack_all_node(&dump, &dump_size, show_flags, uid,
+		      msg->protocol_version);
+	part_key = _pack_cache_part_key(uid, show_flags);
+	cache_buf = _pack_cache_put(node_pack_cache, part_key, show_flags,
+				    msg->protocol_version, update_time,
+				    pack_time, dump, dump_size);
+	xfree(part_key);
+	unlock_slurmctld(node_write_lock);
+
+send_msg:
+	END_TIMER2("_slurm_rpc_dump_nodes");
 #if 0
-		info("_slurm_rpc_dump_nodes, size=%d %s", dump_size, TIME_STR);
+	info("_slurm_rpc_dump_nodes, size=%d %s", dump_size, TIME_STR);
 #endif
 
-		/* init response_msg structure */
-		slurm_msg_t_init(&response_msg);
-		response_msg.flags = msg->flags;
-		response_msg.protocol_version = msg->protocol_version;
-		response_msg.address = msg->address;
-		response_msg.msg_type = RESPONSE_NODE_INFO;
-		response_msg.data = dump;
-		response_msg.data_size = dump_size;
+	/* init response_msg structure */
+	slurm_msg_t_init(&response_msg);
+	response_msg.flags = msg->flags;
+	response_msg.protocol_version = msg->protocol_version;
+	response_msg.address = msg->address;
+	response_msg.msg_type = RESPONSE_NODE_INFO;
+	response_msg.data = cache_buf->data;
+	response_msg.data_size = cache_buf->data_size;
 
-		/* send message */
-		slurm_send_node_msg(msg->conn_fd, &response_msg);
-		xfree(dump);
-	}
+	/* send message */
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	_pack_cache_release(cache_buf);
 }
 
 /* _slurm_rpc_dump_node_single - done RPC state information for one node */
@@ -1546,6 +1892,9 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t * msg)
 	slurmctld_lock_t part_read_lock = {
 		READ_LOCK, NO_LOCK, NO_LOCK, READ_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
+	pack_cache_buf_t *cache_buf = NULL;
+	time_t pack_time, update_time[4];
+	char *part_key = NULL;
 
 	START_TIMER;
 	debug2("Processing RPC: REQUEST_PARTITION_INFO uid=%d", uid);
@@ -1558,35 +1907,65 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t * msg)
 		debug2("Security violation, PARTITION_INFO RPC from uid=%d",
 		       uid);
 		slurm_send_rc_msg(msg, ESLURM_ACCESS_DENIED);
-	} else if ((part_req_msg->last_update - 1) >= last_part_update) {
+		return;
+	}
+
+	if ((part_req_msg->last_update - 1) >= last_part_update) {
 		unlock_slurmctld(part_read_lock);
 		debug2("_slurm_rpc_dump_partitions, no change");
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
-	} else {
+		return;
+	}
+
+	/* The partition lock is held throughout, so a cached response can
+	 * be validated and a new one packed without relocking */
+	update_time[0] = slurmctld_conf.last_update;
+	update_time[1] = 0;
+	update_time[2] = 0;
+	update_time[3] = last_part_update;
+	pack_time = time(NULL);
+	part_key = _pack_cache_part_key(uid, part_req_msg->show_flags);
+	cache_buf = _pack_cache_get(part_pack_cache, part_key,
+				    part_req_msg->show_flags,
+				    msg->protocol_version, update_time);
+	if (!cache_buf) {
 		pack_all_part(&dump, &dump_size, part_req_msg->show_flags,
 			      uid, msg->protocol_version);
-		unlock_slurmctld(part_read_lock);
-		END_TIMER2("_slurm_rpc_dump_partitions");
-		debug2("_slurm_rpc_dump_partitions, size=%d %s",
-		       dump_size, TIME_STR);
+		cache_buf = _pack_cache_put(part_pack_cache, part_key,
+					    part_req_msg->show_flags,
+					    msg->protocol_version, update_time,
+					    pack_time, dump, dump_size);
+	}
+	xfree(part_key);
+	unlock_slurmctld(part_read_lock);
 
-		/* init response_msg structure */
-		slurm_msg_t_init(&response_msg);
-		response_msg.flags = msg->flags;
-		response_msg.protocol_version = msg->protocol_version;
-		response_msg.address = msg->address;
-		response_msg.msg_type = RESPONSE_PARTITION_INFO;
-		response_msg.data = dump;
-		response_msg.data_size = dump_size;
+	END_TIMER2("_slurm_rpc_dump_partitions");
+	debug2("_slurm_rpc_dump_partitions, size=%d %s",
+	       cache_buf->data_size, TIME_STR);
 
-		/* send message */
-		slurm_send_node_msg(msg->conn_fd, &response_msg);
-		xfree(dump);
-	}
+	/* init response_msg structure */
+	slurm_msg_t_init(&response_msg);
+	response_msg.flags = msg->flags;
+	response_msg.protocol_version = msg->protocol_version;
+	response_msg.address = msg->address;
+	response_msg.msg_type = RESPONSE_PARTITION_INFO;
+	response_msg.data = cache_buf->data;
+	response_msg.data_size = cache_buf->data_size;
+
+	/* send message */
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	_pack_cache_release(cache_buf);
 }
 
 /* _slurm_rpc_epilog_complete - process RPC noting the completion of
- * the epilog denoting the completion of a job it its entirety */
+ * the epilog denoting the completion of a job it its entirety
+ *
+ * Every node of a job sends this RPC when the job ends, so they arrive
+ * in bursts.  Messages are queued on epilog_list and whichever thread
+ * finds no other thread processing the queue processes every queued
+ * message, including those which arrive while it is working.  The job
+ * write lock is taken once for up to EPILOG_BATCH_MAX messages, then
+ * released so that other RPCs are not blocked by a long burst. */
 static void  _slurm_rpc_epilog_complete(slurm_msg_t * msg)
 {
 	static time_t config_update = 0;
@@ -1601,8 +1980,9 @@ static void  _slurm_rpc_epilog_complete(slurm_msg_t * msg)
 	bool run_scheduler = false;
 	struct job_record  *job_ptr;
 	char jbuf[JBUFSIZ];
+	int batch_cnt, msg_cnt = 0;
+	bool drained = false;
 
-	START_TIMER;
 	debug2("Processing RPC: MESSAGE_EPILOG_COMPLETE uid=%d", uid);
 	if (!validate_slurm_user(uid)) {
 		error("Security violation, EPILOG_COMPLETE RPC from uid=%d",
@@ -1610,29 +1990,64 @@ static void  _slurm_rpc_epilog_complete(slurm_msg_t * msg)
 		return;
 	}
 
-	job_ptr = find_job_record(epilog_msg->job_id);
+	/* Take ownership of the message, it is freed once processed */
+	slurm_mutex_lock(&epilog_mutex);
+	if (!epilog_list) {
+		epilog_list = list_create((ListDelF)
+					  slurm_free_epilog_complete_msg);
+	}
+	list_append(epilog_list, epilog_msg);
+	msg->data = NULL;
+	if (epilog_draining) {
+		slurm_mutex_unlock(&epilog_mutex);
+		return;
+	}
+	epilog_draining = true;
 	if (config_update != slurmctld_conf.last_update) {
 		char *sched_params = slurm_get_sched_params();
 		defer_sched = (sched_params && strstr(sched_params,"defer"));
 		xfree(sched_params);
+		config_update = slurmctld_conf.last_update;
 	}
+	slurm_mutex_unlock(&epilog_mutex);
 
-	lock_slurmctld(job_write_lock);
-	if (job_epilog_complete(epilog_msg->job_id, epilog_msg->node_name,
-				epilog_msg->return_code))
-		run_scheduler = true;
-	unlock_slurmctld(job_write_lock);
-	END_TIMER2("_slurm_rpc_epilog_complete");
+	START_TIMER;
+	while (!drained) {
+		lock_slurmctld(job_write_lock);
+		for (batch_cnt = 0; batch_cnt < EPILOG_BATCH_MAX;
+		     batch_cnt++) {
+			slurm_mutex_lock(&epilog_mutex);
+			epilog_msg = list_pop(epilog_list);
+			if (!epilog_msg) {
+				epilog_draining = false;
+				drained = true;
+			}
+			slurm_mutex_unlock(&epilog_mutex);
+			if (!epilog_msg)
+				break;
 
-	if (epilog_msg->return_code)
-		error("%s: epilog error %s Node=%s Err=%s %s",
-		      __func__, jobid2str(job_ptr, jbuf),
-		      epilog_msg->node_name,
-		      slurm_strerror(epilog_msg->return_code), TIME_STR);
-	else
-		debug2("%s: %s Node=%s %s",
-		       __func__, jobid2str(job_ptr, jbuf),
-		       epilog_msg->node_name, TIME_STR);
+			msg_cnt++;
+			if (job_epilog_complete(epilog_msg->job_id,
+						epilog_msg->node_name,
+						epilog_msg->return_code))
+				run_scheduler = true;
+
+			job_ptr = find_job_record(epilog_msg->job_id);
+			if (epilog_msg->return_code)
+				error("%s: epilog error %s Node=%s Err=%s",
+				      __func__, jobid2str(job_ptr, jbuf),
+				      epilog_msg->node_name,
+				      slurm_strerror(epilog_msg->return_code));
+			else
+				debug2("%s: %s Node=%s",
+				       __func__, jobid2str(job_ptr, jbuf),
+				       epilog_msg->node_name);
+			slurm_free_epilog_complete_msg(epilog_msg);
+		}
+		unlock_slurmctld(job_write_lock);
+	}
+	END_TIMER2("_slurm_rpc_epilog_complete");
+	debug2("%s: processed %d messages %s", __func__, msg_cnt, TIME_STR);
 
 	/* Functions below provide their own locking */
 	if (run_scheduler) {
@@ -3062,8 +3477,9 @@ static void _slurm_rpc_submit_batch_job(slurm_msg_t * msg)
 	}
 
 	dump_job_desc(job_desc_msg);
+	if (error_code == SLURM_SUCCESS)
+		error_code = _throttle_try_start(&active_rpc_cnt);
 	if (error_code == SLURM_SUCCESS) {
-		_throttle_start(&active_rpc_cnt);
 		lock_slurmctld(job_write_lock);
 		START_TIMER;	/* Restart after we have locks */
 		if (job_desc_msg->job_id != SLURM_BATCH_SCRIPT) {
@@ -54,6 +54,9 @@ typedef struct connection_arg {
 /* Free memory used to track RPC usage by type and user */
 extern void free_rpc_stats(void);
 
+/* Free job, node and partition information packed for reuse */
+extern void pack_cache_fini(void);
+
 /*
  * slurmctld_req  - Process an individual RPC request
  * IN/OUT msg - the request message, data associated with the message is freed
@@ -91,6 +91,7 @@
 #include "src/slurmctld/sched_plugin.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/srun_comm.h"
+#include "src/slurmctld/state_save.h"
 #include "src/slurmctld/trigger_mgr.h"
 
 bool slurmctld_init_db = 1;
@@ -2138,7 +2139,6 @@ extern int dump_config_state_lite(void)
 
 extern int load_config_state_lite(void)
 {
-	int data_allocated, data_read = 0;
 	uint32_t data_size = 0, uint32_tmp = 0;
 	uint16_t ver = 0;
 	int state_fd;
@@ -2156,25 +2156,7 @@ extern int load_config_state_lite(void)
 	if (state_fd < 0) {
 		debug2("No last_config_lite file (%s) to recover", state_file);
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					 BUF_SIZE);
-			if (data_read < 0) {
-				if (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-					      state_file);
-					break;
-				}
-			} else if (data_read == 0)	/* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		data = read_state_file(state_fd, state_file, 0, &data_size);
 		close(state_fd);
 	}
 	xfree(state_file);
@@ -2851,7 +2851,7 @@ extern int load_all_resv_state(int recover)
 	char *state_file, *data = NULL, *ver_str = NULL;
 	time_t now;
 	uint32_t data_size = 0, uint32_tmp;
-	int data_allocated, data_read = 0, error_code = 0, state_fd;
+	int error_code = 0, state_fd;
 	Buf buffer;
 	slurmctld_resv_t *resv_ptr = NULL;
 	uint16_t protocol_version = (uint16_t) NO_VAL;
@@ -2876,25 +2876,7 @@ extern int load_all_resv_state(int recover)
 		     state_file);
 		error_code = ENOENT;
 	} else {
-		data_allocated = BUF_SIZE;
-		data = xmalloc(data_allocated);
-		while (1) {
-			data_read = read(state_fd, &data[data_size],
-					BUF_SIZE);
-			if (data_read < 0) {
-				if  (errno == EINTR)
-					continue;
-				else {
-					error("Read error on %s: %m",
-						state_file);
-					break;
-				}
-			} else if (data_read == 0)     /* eof */
-				break;
-			data_size      += data_read;
-			data_allocated += data_read;
-			xrealloc(data, data_allocated);
-		}
+		data = read_state_file(state_fd, state_file, 0, &data_size);
 		close(state_fd);
 	}
 	xfree(state_file);
@@ -3014,10 +2996,8 @@ static int  _resize_resv(slurmctld_resv_t *resv_ptr, uint32_t node_cnt)
 				FREE_NULL_BITMAP(tmp2_bitmap);
 				delta_node_cnt = 0;	/* ALL DONE */
 			} else if (i) {
-				bit_not(idle_node_bitmap);
-				bit_and(resv_ptr->node_bitmap,
+				bit_and_not(resv_ptr->node_bitmap,
 					idle_node_bitmap);
-				bit_not(idle_node_bitmap);
 				resv_ptr->node_cnt = bit_set_count(
 						resv_ptr->node_bitmap);
 				delta_node_cnt = resv_ptr->node_cnt -
@@ -3132,9 +3112,7 @@ static int  _select_nodes(resv_desc_msg_t *resv_desc_ptr,
 				resv_ptr->full_nodes = 1;
 			}
 			if (resv_ptr->full_nodes) {
-				bit_not(resv_ptr->node_bitmap);
-				bit_and(node_bitmap, resv_ptr->node_bitmap);
-				bit_not(resv_ptr->node_bitmap);
+				bit_and_not(node_bitmap, resv_ptr->node_bitmap);
 			} else {
 				if (*core_bitmap == NULL)
 					_create_cluster_core_bitmap(core_bitmap);
@@ -3433,9 +3411,7 @@ static bitstr_t *_pick_idle_node_cnt(bitstr_t *avail_bitmap,
 			continue;
 
 		if (!resv_desc_ptr->core_cnt) {
-			bit_not(job_ptr->node_bitmap);
-			bit_and(avail_bitmap, job_ptr->node_bitmap);
-			bit_not(job_ptr->node_bitmap);
+			bit_and_not(avail_bitmap, job_ptr->node_bitmap);
 		} else {
 			_check_job_compatibility(job_ptr, avail_bitmap,
 						 core_bitmap);
@@ -3876,9 +3852,8 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 				continue;
 			if (bit_overlap(*node_bitmap, res2_ptr->node_bitmap)) {
 				*resv_overlap = true;
-				bit_not(res2_ptr->node_bitmap);
-				bit_and(*node_bitmap, res2_ptr->node_bitmap);
-				bit_not(res2_ptr->node_bitmap);
+				bit_and_not(*node_bitmap,
+					res2_ptr->node_bitmap);
 			}
 		}
 		list_iterator_destroy(iter);
@@ -3963,9 +3938,8 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 				     "will not share nodes",
 				     resv_ptr->name, job_ptr->job_id);
 #endif
-				bit_not(resv_ptr->node_bitmap);
-				bit_and(*node_bitmap, resv_ptr->node_bitmap);
-				bit_not(resv_ptr->node_bitmap);
+				bit_and_not(*node_bitmap,
+					resv_ptr->node_bitmap);
 			} else {
 #if _DEBUG
 				info("job_test_resv: reservation %s uses "
@@ -256,6 +256,11 @@ extern bitstr_t *idle_node_bitmap;	/* bitmap of idle nodes */
 extern bitstr_t *power_node_bitmap;	/* Powered down nodes */
 extern bitstr_t *share_node_bitmap;	/* bitmap of sharable nodes */
 extern bitstr_t *up_node_bitmap;	/* bitmap of up nodes, not DOWN */
+extern uint32_t node_config_update_cnt;	/* bumped when node features, gres
+					 * or weight are changed */
+extern uint32_t node_usage_update_cnt;	/* bumped when jobs are allocated,
+					 * released, suspended or resumed
+					 * on nodes */
 
 /*****************************************************************************\
  *  FRONT_END parameters and data structures
@@ -665,6 +670,8 @@ struct job_record {
 					 * started with */
 	time_t start_time;		/* time execution begins,
 					 * actual or expected */
+	struct job_state_cache *state_cache; /* packed state save record of
+					 * finished job, see job_mgr.c */
 	char *state_desc;		/* optional details for state_reason */
 	uint32_t state_reason;		/* reason job still pending or failed
 					 * see slurm.h:enum job_wait_reason */
@@ -2006,6 +2013,11 @@ extern bool test_job_array_completed(uint32_t array_job_id);
 /* Return true if ANY tasks of specific array job ID are pending */
 extern bool test_job_array_pending(uint32_t array_job_id);
 
+/* Determine if ALL tasks of specific array job ID are complete, ALL are
+ * completed and ANY are pending, using a single scan of its records */
+extern void test_job_array_state(uint32_t array_job_id, bool *complete,
+				 bool *completed, bool *pending);
+
 /*
  * Synchronize the batch job in the system with their files.
  * All pending batch jobs must have script and environment files
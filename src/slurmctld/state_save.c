@@ -49,7 +49,10 @@
 #  include <pthread.h>
 #endif                          /* WITH_PTHREADS */
 
+#include <sys/stat.h>
+
 #include "src/common/macros.h"
+#include "src/common/xmalloc.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/reservation.h"
 #include "src/slurmctld/slurmctld.h"
@@ -98,6 +101,57 @@ extern int fsync_and_close(int fd, char *file_type)
 	return rc;
 }
 
+/*
+ * Read the contents of a state save file into memory. The buffer is sized
+ * from fstat() so that a large file is read with a few large read() calls
+ * rather than being grown and copied BUF_SIZE bytes at a time.
+ * fd IN - open file descriptor, left open
+ * file_name IN - name of the file, for error messages
+ * max_size IN - stop after reading this many bytes, 0 for the whole file
+ * data_size OUT - count of bytes read
+ * RET - xmalloc'ed data, never NULL
+ */
+extern char *read_state_file(int fd, char *file_name, uint32_t max_size,
+			     uint32_t *data_size)
+{
+	struct stat stat_buf;
+	uint32_t data_allocated = BUF_SIZE, size = 0;
+	char *data;
+	ssize_t data_read;
+
+	/* Leave a spare byte so that end of file is reached without growing
+	 * the buffer when the file size is unchanged */
+	if ((fstat(fd, &stat_buf) == 0) && (stat_buf.st_size > 0) &&
+	    (stat_buf.st_size < (MAX_BUF_SIZE - 1)))
+		data_allocated = stat_buf.st_size + 1;
+	if (max_size && (data_allocated > max_size))
+		data_allocated = max_size;
+	data = xmalloc(data_allocated);
+
+	while (!max_size || (size < max_size)) {
+		if (size == data_allocated) {
+			if (data_allocated > (MAX_BUF_SIZE / 2)) {
+				error("State file %s too large", file_name);
+				break;
+			}
+			data_allocated *= 2;
+			xrealloc(data, data_allocated);
+		}
+		data_read = read(fd, &data[size], data_allocated - size);
+		if (data_read < 0) {
+			if (errno == EINTR)
+				continue;
+			error("Read error on %s: %m", file_name);
+			break;
+		} else if (data_read == 0)	/* eof */
+			break;
+		size += data_read;
+	}
+
+	*data_size = size;
+	return data;
+}
+
 /* Queue saving of front_end state information */
 extern void schedule_front_end_save(void)
 {
@@ -45,6 +45,17 @@
  * RET 0 on success or -1 on error */
 extern int fsync_and_close(int fd, char *file_type);
 
+/*
+ * Read the contents of a state save file into memory
+ * fd IN - open file descriptor, left open
+ * file_name IN - name of the file, for error messages
+ * max_size IN - stop after reading this many bytes, 0 for the whole file
+ * data_size OUT - count of bytes read
+ * RET - xmalloc'ed data, never NULL
+ */
+extern char *read_state_file(int fd, char *file_name, uint32_t max_size,
+			     uint32_t *data_size);
+
 /* Queue saving of front_end state information */
 extern void schedule_front_end_save(void);
 
@@ -2027,10 +2027,8 @@ static void _step_dealloc_lps(struct step_record *step_ptr)
 	xassert(job_resrcs_ptr->core_bitmap_used);
 	if (step_ptr->core_bitmap_job) {
 		/* Mark the job's cores as no longer in use */
-		bit_not(step_ptr->core_bitmap_job);
-		bit_and(job_resrcs_ptr->core_bitmap_used,
+		bit_and_not(job_resrcs_ptr->core_bitmap_used,
 			step_ptr->core_bitmap_job);
-		/* no need for bit_not(step_ptr->core_bitmap_job); */
 		FREE_NULL_BITMAP(step_ptr->core_bitmap_job);
 	}
 #endif
@@ -91,6 +91,8 @@ static int   _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 			    Buf in_buffer, Buf *out_buffer, uint32_t *uid);
 static int   _get_probs(slurmdbd_conn_t *slurmdbd_conn,
 			Buf in_buffer, Buf *out_buffer, uint32_t *uid);
+static void  _pack_job_list_msg(List job_list, uint16_t rpc_version,
+				Buf buffer);
 static int   _get_qos(slurmdbd_conn_t *slurmdbd_conn,
 		      Buf in_buffer, Buf *out_buffer, uint32_t *uid);
 static int   _get_res(slurmdbd_conn_t *slurmdbd_conn,
@@ -467,11 +469,15 @@ proc_req(slurmdbd_conn_t *slurmdbd_conn,
 			      slurmdbd_conn->newsockfd,
 			      slurmdbd_msg_type_2_str(msg_type, 1));
 		else if (slurmdbd_conn->ctld_port
+			 && !slurmdbd_conn->mult_msg
+			 && (msg_type != DBD_SEND_MULT_MSG)
 			 && !slurmdbd_conf->commit_delay) {
 			/* If we are dealing with the slurmctld do the
 			   commit (SUCCESS or NOT) afterwards since we
 			   do transactions for performance reasons.
 			   (don't ever use autocommit with innodb)
+			   The messages in a DBD_SEND_MULT_MSG are
+			   committed together by _send_mult_msg().
 			*/
 			acct_storage_g_commit(slurmdbd_conn->db_conn, 1);
 		}
@@ -1381,8 +1387,8 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 			list_msg.my_list = list_create(NULL);
 		*out_buffer = init_buf(1024);
 		pack16((uint16_t) DBD_GOT_JOBS, *out_buffer);
-		slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->rpc_version,
-				       DBD_GOT_JOBS, *out_buffer);
+		_pack_job_list_msg(list_msg.my_list,
+				   slurmdbd_conn->rpc_version, *out_buffer);
 	} else {
 		*out_buffer = make_dbd_rc_msg(slurmdbd_conn->rpc_version,
 					      errno, slurm_strerror(errno),
@@ -1397,6 +1403,26 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 	return rc;
 }
 
+/* Pack job_list the same way slurmdbd_pack_list_msg() does for
+ * DBD_GOT_JOBS, but free each job record as soon as it has been packed.
+ * A large sacct query otherwise holds the complete job list and the
+ * complete packed reply in memory at the same time.  The list is empty
+ * on return. */
+static void _pack_job_list_msg(List job_list, uint16_t rpc_version,
+			       Buf buffer)
+{
+	slurmdb_job_rec_t *job = NULL;
+
+	pack32(list_count(job_list), buffer);
+	while ((job = list_pop(job_list))) {
+		slurmdb_pack_job_rec(job, rpc_version, buffer);
+		slurmdb_destroy_job_rec(job);
+	}
+
+	if (rpc_version >= 8)
+		pack32(SLURM_SUCCESS, buffer);
+}
+
 static int _get_probs(slurmdbd_conn_t *slurmdbd_conn,
 		      Buf in_buffer, Buf *out_buffer, uint32_t *uid)
 {
@@ -3753,6 +3779,7 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 
 	list_msg.my_list = list_create(slurmdbd_free_buffer);
 
+	slurmdbd_conn->mult_msg = true;
 	itr = list_iterator_create(get_msg->my_list);
 	while ((req_buf = list_next(itr))) {
 		ret_buf = NULL;
@@ -3764,9 +3791,28 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 			break;
 	}
 	list_iterator_destroy(itr);
+	slurmdbd_conn->mult_msg = false;
 
 	slurmdbd_free_list_msg(get_msg);
 
+	/* All of the messages share one transaction. If it can not be
+	 * committed (e.g. the database connection was lost and
+	 * re-established part way through the batch) the messages
+	 * already processed were lost too, so do not report any of them
+	 * as done. The sender then resends the whole batch. */
+	if (slurmdbd_conn->ctld_port && !slurmdbd_conf->commit_delay) {
+		rc = acct_storage_g_commit(slurmdbd_conn->db_conn, 1);
+		if (rc != SLURM_SUCCESS) {
+			comment = "Failed to commit DBD_SEND_MULT_MSG messages";
+			error("CONN:%u %s", slurmdbd_conn->newsockfd, comment);
+			list_destroy(list_msg.my_list);
+			*out_buffer = make_dbd_rc_msg(
+				slurmdbd_conn->rpc_version, rc, comment,
+				DBD_SEND_MULT_MSG);
+			return rc;
+		}
+	}
+
 	*out_buffer = init_buf(1024);
 	pack16((uint16_t) DBD_GOT_MULT_MSG, *out_buffer);
 	slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->rpc_version,
@@ -202,6 +202,128 @@ main(int argc, char *argv[])
 		TEST(bit_equal(bs, bs2), "bitstring");
 	}
 
+	note("Testing word boundaries");
+	{
+		bitstr_t *bs1 = bit_alloc(200);
+		bitstr_t *bs2 = bit_alloc(200);
+
+		TEST(bit_ffs(bs1) == -1, "ffs empty");
+		TEST(bit_fls(bs1) == -1, "fls empty");
+		TEST(bit_ffc(bs1) == 0, "ffc empty");
+		bit_set(bs1, 63);
+		bit_set(bs1, 64);
+		bit_set(bs1, 199);
+		TEST(bit_ffs(bs1) == 63, "ffs word boundary");
+		TEST(bit_fls(bs1) == 199, "fls last bit");
+		TEST(bit_set_count(bs1) == 3, "set count");
+		bit_nset(bs1, 0, 62);
+		TEST(bit_ffc(bs1) == 65, "ffc word boundary");
+		bit_nset(bs1, 65, 198);
+		TEST(bit_ffc(bs1) == -1, "ffc full");
+		TEST(bit_clear_count(bs1) == 0, "clear count full");
+
+		/* bit_not sets the unused bits of the last word */
+		bit_not(bs2);
+		TEST(bit_set_count(bs2) == 200, "set count after not");
+		TEST(bit_fls(bs2) == 199, "fls after not");
+		TEST(bit_overlap(bs1, bs2) == 200, "overlap");
+		bit_nclear(bs2, 100, 199);
+		TEST(bit_overlap(bs1, bs2) == 100, "overlap partial");
+		TEST(bit_super_set(bs2, bs1) == 1, "super set");
+
+		bit_and_not(bs1, bs2);
+		TEST(bit_set_count(bs1) == 100, "and_not count");
+		TEST(bit_ffs(bs1) == 100, "and_not ffs");
+		TEST(bit_test(bs2, 0), "and_not preserves b2");
+
+		bit_nclear(bs1, 0, 199);
+		bit_nset(bs1, 64, 191);
+		TEST(bit_nffs(bs1, 128) == 64, "nffs whole words");
+		TEST(bit_nffc(bs1, 64) == 0, "nffc whole words");
+		TEST(bit_nffc(bs1, 65) == -1, "nffc no fit");
+
+		bit_free(bs1);
+		bit_free(bs2);
+	}
+
+	note("Testing reuse of freed bitstrings");
+	{
+		bitstr_t *bs1, *bs2;
+
+		bit_cache_begin();
+		bs1 = bit_alloc(300);
+		bit_nset(bs1, 0, 299);
+		bs2 = bit_copy(bs1);
+		bit_free(bs1);
+		bs1 = bit_alloc(300);
+		TEST(bit_set_count(bs1) == 0, "reused bitstring clear");
+		bit_free(bs1);
+		bs1 = bit_copy(bs2);
+		TEST(bit_set_count(bs1) == 300, "reused bitstring copy");
+		TEST(bit_size(bs1) == 300, "reused bitstring size");
+		bit_free(bs1);
+		bit_free(bs2);
+		bit_cache_end();
+		bit_cache_fini();
+	}
+
+	note("Testing eviction of least recently used bitstring size");
+	{
+		bitstr_t *bs[5], *bs1;
+		int i;
+
+		bit_cache_begin();
+		for (i = 0; i < 5; i++)
+			bs[i] = bit_alloc((i + 1) * 100);
+		for (i = 0; i < 4; i++)
+			bit_free(bs[i]);
+		bs1 = bit_alloc(100);
+		TEST(bs1 == bs[0], "cached bitstring reused");
+		bit_free(bs1);
+		bit_free(bs[4]);	/* evicts size 200, not size 100 */
+		bs1 = bit_alloc(100);
+		TEST(bs1 == bs[0], "recently used size kept");
+		bit_free(bs1);
+		bs1 = bit_alloc(500);
+		TEST(bs1 == bs[4], "new size cached");
+		bit_free(bs1);
+		bit_cache_end();
+		bit_cache_fini();
+	}
+
+	note("Timing bitstring operations");
+	{
+		bitstr_t *bs1 = bit_alloc(100000);
+		bitstr_t *bs2 = bit_alloc(100000);
+		struct timeval tv1, tv2;
+		int32_t cnt = 0;
+		long delta_t;
+		int i;
+
+		for (i = 0; i < 100000; i += 3)
+			bit_set(bs1, i);
+		for (i = 50000; i < 100000; i += 2)
+			bit_set(bs2, i);
+
+		gettimeofday(&tv1, NULL);
+		for (i = 0; i < 1000; i++) {
+			bit_and_not(bs1, bs2);
+			cnt += bit_overlap(bs1, bs2);
+			cnt += bit_set_count(bs1);
+			cnt += bit_ffs(bs2) + bit_fls(bs1);
+			cnt += bit_super_set(bs1, bs2);
+		}
+		gettimeofday(&tv2, NULL);
+		delta_t  = (tv2.tv_sec  - tv1.tv_sec) * 1000000;
+		delta_t += tv2.tv_usec - tv1.tv_usec;
+		note("1000 iterations on 100000 bit bitstrings took %ld usec",
+		     delta_t);
+		TEST(cnt > 0, "timing");
+
+		bit_free(bs1);
+		bit_free(bs2);
+	}
+
 	totals();
 	return failed;
 }